@@ -0,0 +1,193 @@
+/**
+ * @file concurrent_union_find.hpp
+ * @brief Class definition (member declaration) of the ConcurrentUnionFind class template.
+ * @note Source files that use member functions should include concurrent_union_find.inline.hpp.
+ */
+#pragma once
+#include "crddagt/common/common.hpp"
+#include "crddagt/common/iterable_union_find.hpp"
+
+#include <atomic>
+
+namespace crddagt {
+
+/**
+ * @brief A union-find data structure that many threads can update at once.
+ *
+ * This class implements a disjoint-set structure over a fixed number of elements
+ * in the style of Jayanti and Tarjan's randomized concurrent union-find:
+ * - **Wait-free find**: Path halving with compare-and-swap. A failed swap is
+ *   ignored rather than retried, since the other writer also moved the element
+ *   closer to its root.
+ * - **Lock-free unite**: The root of lower priority is linked under the other
+ *   root with one compare-and-swap, retried only if another thread linked one
+ *   of the roots first.
+ * - **Randomized linking**: Each element has a fixed pseudo-random priority
+ *   derived from its index and a seed, which keeps expected tree height
+ *   logarithmic without the rank bookkeeping that would need a second atomic.
+ * - **Member enumeration**: Each successful link pushes the linked root onto a
+ *   lock-free child stack of the root it was linked under. The stacks are never
+ *   popped, so a class is the tree of stacks below its root.
+ *
+ * @tparam Idx The index type, defaults to size_t. Must be unsigned, and
+ *         `std::atomic<Idx>` must be lock-free.
+ *
+ * @par Thread Safety
+ * - find(), unite() and same_class() may be called concurrently from any thread.
+ * - The remaining queries and export_to() require quiescence: no concurrent
+ *   unite() calls, and all earlier ones visible to the caller (for example,
+ *   after joining the threads that made them).
+ *
+ * @par Determinism
+ * The partition depends only on the unite() calls made. The root of each class
+ * is its element of highest priority among the roots present at construction,
+ * so it does not depend on thread timing either.
+ *
+ * @par Index Validation
+ * All operations validate indices and throw std::runtime_error with a descriptive
+ * message if an index is out of range.
+ */
+template <typename Idx = size_t>
+class ConcurrentUnionFind {
+public:
+    static_assert(std::is_unsigned_v<Idx>,
+                  "ConcurrentUnionFind: Idx must be an unsigned type");
+
+    static_assert(sizeof(Idx) <= sizeof(size_t),
+                  "ConcurrentUnionFind: Idx size must not exceed size_t size");
+
+    static_assert(std::atomic<Idx>::is_always_lock_free,
+                  "ConcurrentUnionFind: std::atomic<Idx> must be lock-free");
+
+    // =========================================================================
+    // Construction
+    // =========================================================================
+
+    /**
+     * @brief Creates count singleton sets.
+     *
+     * @param count The number of elements.
+     * @param seed Seed for the linking priorities.
+     * @throw std::overflow_error if count exceeds the maximum of Idx.
+     */
+    explicit ConcurrentUnionFind(size_t count, uint64_t seed = 0);
+
+    /**
+     * @brief Creates a structure with the same partition as initial.
+     *
+     * Each class starts as a root with all its other members directly below it.
+     *
+     * @param initial The partition to start from. Its aggregates are not used.
+     * @param seed Seed for the linking priorities.
+     */
+    template <typename Aggregate, typename Storage>
+    explicit ConcurrentUnionFind(const IterableUnionFind<Idx, Aggregate, Storage>& initial, uint64_t seed = 0);
+
+    ConcurrentUnionFind(const ConcurrentUnionFind&) = delete;
+    ConcurrentUnionFind& operator=(const ConcurrentUnionFind&) = delete;
+
+    /**
+     * @brief Returns the number of elements.
+     */
+    [[nodiscard]] size_t element_count() const noexcept;
+
+    // =========================================================================
+    // Concurrent Operations
+    // =========================================================================
+
+    /**
+     * @brief Finds the current root of the set containing x, with path halving.
+     *
+     * Wait-free. Under concurrent unite() calls the returned root may already
+     * have been linked below another root by the time the caller uses it.
+     *
+     * @param x The element to find the root of
+     * @return The root of the set containing x
+     * @throw std::runtime_error if x is out of range
+     */
+    Idx find(Idx x);
+
+    /**
+     * @brief Merges the sets containing a and b.
+     *
+     * Lock-free and linearizable: of several concurrent calls that would merge
+     * the same two classes, exactly one returns true.
+     *
+     * @param a An element in the first set
+     * @param b An element in the second set
+     * @return true if a merge occurred, false if a and b were already in the same set
+     * @throw std::runtime_error if a or b is out of range
+     */
+    bool unite(Idx a, Idx b);
+
+    /**
+     * @brief Checks if two elements are in the same equivalence class.
+     *
+     * Linearizable: the answer was true at some instant during the call.
+     *
+     * @throw std::runtime_error if a or b is out of range
+     */
+    [[nodiscard]] bool same_class(Idx a, Idx b);
+
+    // =========================================================================
+    // Quiescent Queries
+    // =========================================================================
+
+    /**
+     * @brief Finds the root of the set containing x, without path compression.
+     *
+     * @throw std::runtime_error if x is out of range
+     */
+    [[nodiscard]] Idx class_root(Idx x) const;
+
+    /**
+     * @brief Populates a vector with all members of the equivalence class containing x.
+     *
+     * The output vector is cleared before populating. Members appear in
+     * breadth-first order of the child stacks, starting from the root.
+     *
+     * @param x An element in the class
+     * @param out Output vector to populate with class members
+     * @throw std::runtime_error if x is out of range
+     */
+    void get_class_members(Idx x, std::vector<Idx>& out) const;
+
+    /**
+     * @brief Replaces the contents of out with the same partition.
+     *
+     * The classes of out have the same roots as this structure, with all
+     * members directly below them, so out.is_flat() is true. Its circular
+     * member lists are valid as for any IterableUnionFind.
+     *
+     * @param out The structure to overwrite. Its aggregates are default constructed.
+     */
+    template <typename Aggregate, typename Storage>
+    void export_to(IterableUnionFind<Idx, Aggregate, Storage>& out) const;
+
+    /**
+     * @brief Same as export_to(out), with the given aggregate for each element.
+     *
+     * @param out The structure to overwrite.
+     * @param element_aggregate Callable taking an element index and returning
+     *        its Aggregate, which out merges per class.
+     */
+    template <typename Aggregate, typename Storage, typename ElementAggregate>
+    void export_to(IterableUnionFind<Idx, Aggregate, Storage>& out, ElementAggregate&& element_aggregate) const;
+
+private:
+    /// True if a root at a must not be linked below a root at b.
+    bool outranks(Idx a, Idx b) const noexcept;
+
+    /// Records that child, a former root, now lies directly below parent.
+    void push_child(Idx parent, Idx child) noexcept;
+
+    void validate_index(Idx x) const;
+
+    size_t m_count;
+    uint64_t m_seed;
+    std::unique_ptr<std::atomic<Idx>[]> m_parent;      ///< Parent pointer (self if root)
+    std::unique_ptr<std::atomic<Idx>[]> m_child_head;  ///< Top of child stack (self if empty)
+    std::unique_ptr<Idx[]> m_sibling;                  ///< Next in the parent's child stack
+};
+
+} // namespace crddagt
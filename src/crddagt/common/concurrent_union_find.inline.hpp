@@ -0,0 +1,236 @@
+/**
+ * @file concurrent_union_find.inline.hpp
+ * @brief Function implementations for the ConcurrentUnionFind class template.
+ */
+#pragma once
+#include "crddagt/common/concurrent_union_find.hpp"
+#include "crddagt/common/iterable_union_find.inline.hpp"
+
+namespace crddagt {
+
+// =============================================================================
+// Construction
+// =============================================================================
+
+template <typename Idx>
+ConcurrentUnionFind<Idx>::ConcurrentUnionFind(size_t count, uint64_t seed)
+    : m_count(count)
+    , m_seed(seed)
+{
+    // Indices must stay below Idx::max, as in IterableUnionFind::make_set()
+    if (count >= static_cast<size_t>(std::numeric_limits<Idx>::max())) {
+        throw std::overflow_error(
+            "ConcurrentUnionFind: cannot create more than " +
+            std::to_string(std::numeric_limits<Idx>::max()) + " elements");
+    }
+    m_parent.reset(new std::atomic<Idx>[count]);
+    m_child_head.reset(new std::atomic<Idx>[count]);
+    m_sibling.reset(new Idx[count]);
+    for (size_t i = 0; i < count; ++i) {
+        m_parent[i].store(static_cast<Idx>(i), std::memory_order_relaxed);
+        m_child_head[i].store(static_cast<Idx>(i), std::memory_order_relaxed);
+        m_sibling[i] = static_cast<Idx>(i);
+    }
+}
+
+template <typename Idx>
+template <typename Aggregate, typename Storage>
+ConcurrentUnionFind<Idx>::ConcurrentUnionFind(const IterableUnionFind<Idx, Aggregate, Storage>& initial,
+                                              uint64_t seed)
+    : ConcurrentUnionFind(initial.element_count(), seed)
+{
+    std::vector<Idx> roots;
+    initial.get_roots(roots);
+    for (size_t i = 0; i < m_count; ++i) {
+        if (roots[i] != static_cast<Idx>(i)) {
+            m_parent[i].store(roots[i], std::memory_order_relaxed);
+            push_child(roots[i], static_cast<Idx>(i));
+        }
+    }
+}
+
+template <typename Idx>
+size_t ConcurrentUnionFind<Idx>::element_count() const noexcept
+{
+    return m_count;
+}
+
+// =============================================================================
+// Concurrent Operations
+// =============================================================================
+
+template <typename Idx>
+Idx ConcurrentUnionFind<Idx>::find(Idx x)
+{
+    validate_index(x);
+    while (true) {
+        Idx parent = m_parent[x].load(std::memory_order_acquire);
+        if (parent == x) {
+            return x;
+        }
+        Idx grandparent = m_parent[parent].load(std::memory_order_acquire);
+        if (grandparent == parent) {
+            return parent;
+        }
+        // Halve the path. On failure another thread has already moved x up,
+        // and grandparent is still an ancestor of x, so continue from it.
+        m_parent[x].compare_exchange_weak(parent, grandparent,
+                                          std::memory_order_release,
+                                          std::memory_order_relaxed);
+        x = grandparent;
+    }
+}
+
+template <typename Idx>
+bool ConcurrentUnionFind<Idx>::unite(Idx a, Idx b)
+{
+    // validate_index called by find()
+    while (true) {
+        Idx root_a = find(a);
+        Idx root_b = find(b);
+        if (root_a == root_b) {
+            return false;  // Already in same class
+        }
+
+        // Link the lower-priority root below the other one
+        if (outranks(root_a, root_b)) {
+            std::swap(root_a, root_b);
+        }
+        Idx expected = root_a;
+        if (m_parent[root_a].compare_exchange_strong(expected, root_b,
+                                                     std::memory_order_acq_rel,
+                                                     std::memory_order_acquire)) {
+            push_child(root_b, root_a);
+            return true;
+        }
+
+        // root_a was linked elsewhere first; retry from the roots just seen
+        a = root_a;
+        b = root_b;
+    }
+}
+
+template <typename Idx>
+bool ConcurrentUnionFind<Idx>::same_class(Idx a, Idx b)
+{
+    while (true) {
+        a = find(a);
+        b = find(b);
+        if (a == b) {
+            return true;
+        }
+        // a was a root when b's root was found, so the classes were distinct then
+        if (m_parent[a].load(std::memory_order_acquire) == a) {
+            return false;
+        }
+    }
+}
+
+// =============================================================================
+// Quiescent Queries
+// =============================================================================
+
+template <typename Idx>
+Idx ConcurrentUnionFind<Idx>::class_root(Idx x) const
+{
+    validate_index(x);
+    Idx parent;
+    while ((parent = m_parent[x].load(std::memory_order_acquire)) != x) {
+        x = parent;
+    }
+    return x;
+}
+
+template <typename Idx>
+void ConcurrentUnionFind<Idx>::get_class_members(Idx x, std::vector<Idx>& out) const
+{
+    out.clear();
+    out.push_back(class_root(x));
+    // out doubles as the work list: visiting out[i] appends its children
+    for (size_t i = 0; i < out.size(); ++i) {
+        const Idx parent = out[i];
+        for (Idx child = m_child_head[parent].load(std::memory_order_acquire);
+             child != parent;
+             child = m_sibling[child]) {
+            out.push_back(child);
+        }
+    }
+}
+
+template <typename Idx>
+template <typename Aggregate, typename Storage>
+void ConcurrentUnionFind<Idx>::export_to(IterableUnionFind<Idx, Aggregate, Storage>& out) const
+{
+    export_to(out, [](Idx) { return Aggregate{}; });
+}
+
+template <typename Idx>
+template <typename Aggregate, typename Storage, typename ElementAggregate>
+void ConcurrentUnionFind<Idx>::export_to(IterableUnionFind<Idx, Aggregate, Storage>& out,
+                                         ElementAggregate&& element_aggregate) const
+{
+    out.clear();
+    out.reserve(m_count);
+    for (size_t i = 0; i < m_count; ++i) {
+        out.make_set(element_aggregate(static_cast<Idx>(i)));
+    }
+
+    // Every class root in order; attaching each member to it as a singleton
+    // keeps out flat and makes the root the same as here.
+    std::vector<Idx> members;
+    for (size_t i = 0; i < m_count; ++i) {
+        const Idx root = static_cast<Idx>(i);
+        if (m_parent[i].load(std::memory_order_acquire) != root) {
+            continue;
+        }
+        get_class_members(root, members);
+        for (size_t k = 1; k < members.size(); ++k) {
+            out.unite(root, members[k]);
+        }
+    }
+}
+
+// =============================================================================
+// Private Helpers
+// =============================================================================
+
+template <typename Idx>
+bool ConcurrentUnionFind<Idx>::outranks(Idx a, Idx b) const noexcept
+{
+    // splitmix64 of the index gives each element a fixed pseudo-random priority
+    auto priority = [this](Idx x) {
+        uint64_t z = static_cast<uint64_t>(x) ^ m_seed;
+        z += 0x9e3779b97f4a7c15ull;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    };
+    const uint64_t pa = priority(a);
+    const uint64_t pb = priority(b);
+    return pa > pb || (pa == pb && a > b);
+}
+
+template <typename Idx>
+void ConcurrentUnionFind<Idx>::push_child(Idx parent, Idx child) noexcept
+{
+    // Each element is pushed at most once, when it stops being a root, and
+    // nothing is ever popped, so the stack has no ABA hazard.
+    Idx head = m_child_head[parent].load(std::memory_order_relaxed);
+    do {
+        m_sibling[child] = head;
+    } while (!m_child_head[parent].compare_exchange_weak(head, child,
+                                                         std::memory_order_release,
+                                                         std::memory_order_relaxed));
+}
+
+template <typename Idx>
+void ConcurrentUnionFind<Idx>::validate_index(Idx x) const
+{
+    if (static_cast<size_t>(x) >= m_count) {
+        throw std::runtime_error(
+            "ConcurrentUnionFind: index " + std::to_string(x) +
+            " out of range [0, " + std::to_string(m_count) + ")");
+    }
+}
+
+} // namespace crddagt
@@ -0,0 +1,241 @@
+/**
+ * @file cow_paged_array.hpp
+ * @brief A paged array whose copies share pages until written (copy-on-write).
+ */
+#pragma once
+#include "crddagt/common/common.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+
+namespace crddagt {
+
+/**
+ * @brief A growable array stored in fixed-size pages that copies share.
+ *
+ * Copying the array copies only its table of page pointers, so it costs
+ * O(size / page_size) regardless of the element type. A page is duplicated
+ * the first time it is written through an array that shares it; pages that
+ * are only read stay shared.
+ *
+ * Reads go through the const operator[]; writes go through mut(), which is
+ * where the sharing check happens. There is deliberately no non-const
+ * operator[], so that a read in a non-const context never copies a page.
+ *
+ * @tparam T The element type. Must be default constructible and copyable.
+ * @tparam PageShift log2 of the number of elements per page.
+ *
+ * @par Thread Safety
+ * - No internal synchronization for a single array.
+ * - Distinct copies may be used concurrently from different threads, even
+ *   while they share pages, since shared pages are never written. Each page
+ *   counts its owners atomically; a write checks the count with acquire
+ *   ordering, so once a copy on another thread has released a page, writes to
+ *   it are ordered after that copy's reads.
+ *
+ * @par Capacity
+ * clear() and shrinking resize() keep their pages, so regrowing does not
+ * allocate, unless a kept page is shared and is then written.
+ */
+template <typename T, size_t PageShift = 12>
+class CowPagedArray {
+public:
+    static constexpr size_t page_size = size_t{1} << PageShift;
+
+    CowPagedArray() = default;
+
+    /**
+     * @brief Shares the pages of other; O(size / page_size).
+     */
+    CowPagedArray(const CowPagedArray& other)
+        : m_pages(other.m_pages)
+        , m_size(other.m_size)
+    {
+        for (Page* page : m_pages) {
+            page->owners.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    CowPagedArray(CowPagedArray&& other) noexcept
+        : m_pages(std::move(other.m_pages))
+        , m_size(other.m_size)
+    {
+        other.m_pages.clear();
+        other.m_size = 0;
+    }
+
+    CowPagedArray& operator=(const CowPagedArray& other)
+    {
+        CowPagedArray copy(other);
+        swap(copy);
+        return *this;
+    }
+
+    CowPagedArray& operator=(CowPagedArray&& other) noexcept
+    {
+        CowPagedArray moved(std::move(other));
+        swap(moved);
+        return *this;
+    }
+
+    ~CowPagedArray()
+    {
+        for (Page* page : m_pages) {
+            release(page);
+        }
+    }
+
+    void swap(CowPagedArray& other) noexcept
+    {
+        m_pages.swap(other.m_pages);
+        std::swap(m_size, other.m_size);
+    }
+
+    /**
+     * @brief Returns the number of elements.
+     */
+    [[nodiscard]] size_t size() const noexcept { return m_size; }
+
+    [[nodiscard]] bool empty() const noexcept { return m_size == 0; }
+
+    /**
+     * @brief Returns element i for reading. i must be less than size().
+     */
+    const T& operator[](size_t i) const
+    {
+        return m_pages[i >> PageShift]->items[i & (page_size - 1)];
+    }
+
+    /**
+     * @brief Returns element i for writing, first copying its page if shared.
+     * i must be less than size().
+     */
+    T& mut(size_t i)
+    {
+        return writable_page(i >> PageShift)[i & (page_size - 1)];
+    }
+
+    /**
+     * @brief Appends an element.
+     */
+    void push_back(const T& value)
+    {
+        if (m_size == m_pages.size() * page_size) {
+            add_page();
+        }
+        mut(m_size) = value;
+        ++m_size;
+    }
+
+    /**
+     * @brief Removes the last element. The array must not be empty.
+     */
+    void pop_back() noexcept { --m_size; }
+
+    /**
+     * @brief Changes the size; elements added by growing are set to value.
+     */
+    void resize(size_t new_size, const T& value = T{})
+    {
+        const size_t page_count = (new_size + page_size - 1) >> PageShift;
+        while (m_pages.size() < page_count) {
+            add_page();
+        }
+        // Fill page by page, so the sharing check happens once per page
+        for (size_t i = m_size; i < new_size;) {
+            const size_t page = i >> PageShift;
+            const size_t end = std::min(new_size, (page + 1) * page_size);
+            T* data = writable_page(page).data();
+            std::fill(data + (i & (page_size - 1)), data + (i & (page_size - 1)) + (end - i), value);
+            i = end;
+        }
+        m_size = new_size;
+    }
+
+    /**
+     * @brief Replaces the contents with count copies of value.
+     */
+    void assign(size_t count, const T& value)
+    {
+        m_size = 0;
+        resize(count, value);
+    }
+
+    /**
+     * @brief Removes all elements, keeping the pages.
+     */
+    void clear() noexcept { m_size = 0; }
+
+    /**
+     * @brief Reserves room in the page table for count elements.
+     */
+    void reserve(size_t count)
+    {
+        m_pages.reserve((count + page_size - 1) >> PageShift);
+    }
+
+    /**
+     * @brief Returns the number of pages currently shared with another copy.
+     *
+     * Intended for testing and monitoring.
+     */
+    [[nodiscard]] size_t shared_page_count() const noexcept
+    {
+        size_t count = 0;
+        for (const Page* page : m_pages) {
+            if (page->owners.load(std::memory_order_relaxed) > 1) {
+                ++count;
+            }
+        }
+        return count;
+    }
+
+private:
+    using Items = std::array<T, page_size>;
+
+    struct Page {
+        Page() = default;
+        explicit Page(const Items& source) : items(source) {}
+
+        std::atomic<size_t> owners{1};  ///< Number of arrays holding the page
+        Items items{};
+    };
+
+    /// Appends a new page owned by this array alone.
+    void add_page()
+    {
+        std::unique_ptr<Page> page(new Page());
+        m_pages.push_back(page.get());
+        page.release();
+    }
+
+    /// Gives up one ownership of page, deleting it if that was the last.
+    static void release(Page* page) noexcept
+    {
+        // The release half orders this owner's reads before the deletion or
+        // before a write by the last owner, whose check is an acquire load
+        if (page->owners.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete page;
+        }
+    }
+
+    /// Makes page p unique to this array, copying it if shared, and returns its items.
+    Items& writable_page(size_t p)
+    {
+        Page*& page = m_pages[p];
+        // A count of 1 cannot grow under us: only this array holds the page,
+        // and copying the array happens on this thread.
+        if (page->owners.load(std::memory_order_acquire) != 1) {
+            Page* copy = new Page(page->items);
+            release(page);
+            page = copy;
+        }
+        return page->items;
+    }
+
+    std::vector<Page*> m_pages;  ///< Owned pages; see release()
+    size_t m_size = 0;
+};
+
+} // namespace crddagt
@@ -0,0 +1,146 @@
+/**
+ * @file critical_path.cpp
+ */
+#include "crddagt/common/critical_path.hpp"
+#include "crddagt/common/step_graph_algorithms.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace crddagt
+{
+
+std::shared_ptr<CriticalPathAnalysis> analyze_critical_path(const ExportedGraph& exported,
+                                                            const std::vector<double>& step_costs)
+{
+    const size_t step_count = exported.step_count;
+    if (step_costs.size() != step_count)
+    {
+        throw std::invalid_argument(
+            "analyze_critical_path: expected " + std::to_string(step_count) +
+            " step costs, got " + std::to_string(step_costs.size()));
+    }
+    for (StepIdx s = 0; s < step_count; ++s)
+    {
+        if (!std::isfinite(step_costs[s]) || step_costs[s] < 0.0)
+        {
+            throw std::invalid_argument(
+                "analyze_critical_path: cost of step " + std::to_string(s) +
+                " is not a finite non-negative number");
+        }
+    }
+
+    std::vector<size_t> offsets;
+    std::vector<StepIdx> targets;
+    build_step_csr(step_count, exported.combined_step_links, offsets, targets);
+
+    // Steps excluded from a partial export take no part in the analysis
+    size_t retained_count = 0;
+    for (StepIdx s = 0; s < step_count; ++s)
+    {
+        retained_count += exported.is_excluded_step(s) ? 0 : 1;
+    }
+
+    // Reuse the exported order when it covers the retained steps; it is checked
+    // against the links below, so a stale order is reported rather than silently used.
+    std::vector<StepIdx> computed_order;
+    const std::vector<StepIdx>* order = &exported.topological_order;
+    if (order->size() != retained_count)
+    {
+        if (!topological_sort(step_count, exported.combined_step_links, computed_order))
+        {
+            throw std::invalid_argument("analyze_critical_path: links contain a cycle");
+        }
+        computed_order.erase(std::remove_if(computed_order.begin(), computed_order.end(),
+                                            [&](StepIdx s) { return exported.is_excluded_step(s); }),
+                             computed_order.end());
+        order = &computed_order;
+    }
+    std::vector<size_t> position(step_count, step_count);
+    for (size_t p = 0; p < retained_count; ++p)
+    {
+        StepIdx s = (*order)[p];
+        if (s >= step_count || position[s] != step_count || exported.is_excluded_step(s))
+        {
+            throw std::invalid_argument(
+                "analyze_critical_path: topological_order is not a permutation of the retained steps");
+        }
+        position[s] = p;
+    }
+
+    auto result = std::make_shared<CriticalPathAnalysis>();
+    CriticalPathAnalysis& a = *result;
+    a.step_count = step_count;
+    a.earliest_start.assign(step_count, 0.0);
+    constexpr double not_applicable = std::numeric_limits<double>::quiet_NaN();
+
+    // Forward pass: earliest start is the latest finish among predecessors.
+    // critical_pred records the predecessor that attained it.
+    constexpr StepIdx no_step = std::numeric_limits<StepIdx>::max();
+    std::vector<StepIdx> critical_pred(step_count, no_step);
+    for (size_t p = 0; p < retained_count; ++p)
+    {
+        StepIdx u = (*order)[p];
+        a.total_work += step_costs[u];
+        const double finish = a.earliest_start[u] + step_costs[u];
+        for (size_t i = offsets[u]; i < offsets[u + 1]; ++i)
+        {
+            StepIdx v = targets[i];
+            if (position[v] <= p)
+            {
+                throw std::invalid_argument(
+                    "analyze_critical_path: topological_order is inconsistent with the links");
+            }
+            if (finish > a.earliest_start[v] ||
+                (finish == a.earliest_start[v] && u < critical_pred[v]))
+            {
+                a.earliest_start[v] = finish;
+                critical_pred[v] = u;
+            }
+        }
+    }
+
+    // The span ends at the step that finishes last
+    StepIdx last = no_step;
+    for (StepIdx s = 0; s < step_count; ++s)
+    {
+        if (exported.is_excluded_step(s))
+        {
+            a.earliest_start[s] = not_applicable;
+            continue;
+        }
+        const double finish = a.earliest_start[s] + step_costs[s];
+        if (last == no_step || finish > a.span)
+        {
+            a.span = finish;
+            last = s;
+        }
+    }
+
+    // Backward pass: latest start is the earliest latest-start among successors,
+    // minus the step's own cost.
+    a.latest_start.assign(step_count, not_applicable);
+    a.slack.assign(step_count, not_applicable);
+    for (size_t p = retained_count; p-- > 0;)
+    {
+        StepIdx u = (*order)[p];
+        double latest_finish = a.span;
+        for (size_t i = offsets[u]; i < offsets[u + 1]; ++i)
+        {
+            latest_finish = std::min(latest_finish, a.latest_start[targets[i]]);
+        }
+        a.latest_start[u] = latest_finish - step_costs[u];
+        // Clamp rounding noise; the true slack is never negative.
+        a.slack[u] = std::max(0.0, a.latest_start[u] - a.earliest_start[u]);
+    }
+
+    for (StepIdx s = last; s != no_step; s = critical_pred[s])
+    {
+        a.critical_path.push_back(s);
+    }
+    std::reverse(a.critical_path.begin(), a.critical_path.end());
+
+    return result;
+}
+
+} // namespace crddagt
@@ -0,0 +1,86 @@
+/**
+ * @file critical_path.hpp
+ * @brief Critical-path analysis of an exported graph with per-step cost estimates.
+ */
+#pragma once
+#include "crddagt/common/common.hpp"
+#include "crddagt/common/graph_core_enums.hpp"
+#include "crddagt/common/exported_graph.hpp"
+
+namespace crddagt
+{
+
+/**
+ * @brief Timing of an exported graph under unlimited parallelism.
+ *
+ * @details
+ * All times are in the unit of the supplied step costs, measured from the start
+ * of the run. A step starts as soon as all steps linked before it have finished.
+ *
+ * @par Use as a scheduling priority
+ * Among ready steps, running the one with the smallest `latest_start` first
+ * (equivalently, the longest remaining path) is the classic critical-path list
+ * scheduling heuristic.
+ *
+ * @par Use for capacity planning
+ * `span` is a lower bound on the makespan for any number of workers, and
+ * `total_work / P` is a lower bound for P workers. `parallelism()` is the
+ * largest worker count that can be kept busy on average.
+ */
+struct CriticalPathAnalysis
+{
+    /// The number of steps.
+    size_t step_count = 0;
+
+    /// Earliest start time of each step, indexed by step index.
+    std::vector<double> earliest_start;
+
+    /// Latest start time of each step that does not delay the whole run.
+    std::vector<double> latest_start;
+
+    /// `latest_start - earliest_start` of each step. Zero on a critical path.
+    std::vector<double> slack;
+
+    /// One longest path through the graph, in execution order.
+    std::vector<StepIdx> critical_path;
+
+    /// The sum of all step costs, excluding steps left out of a partial export.
+    double total_work = 0.0;
+
+    /// The length of the critical path: the makespan with unlimited workers.
+    double span = 0.0;
+
+    /// `total_work / span`, or 0 if the span is zero.
+    double parallelism() const
+    {
+        return span > 0.0 ? total_work / span : 0.0;
+    }
+};
+
+/**
+ * @brief Computes earliest and latest start times, slack and a critical path.
+ *
+ * Runs in O(V + E) over the combined step links. The topological order stored
+ * in the exported graph is used if it covers every retained step; otherwise one
+ * is computed.
+ *
+ * Steps excluded from a partial export (see `ExportedGraph::is_excluded_step()`)
+ * are left out: their costs count toward neither `total_work` nor `span`, and
+ * their start times and slack are NaN.
+ *
+ * When several paths are equally long, the critical path follows the
+ * lowest-index predecessor that attains the maximum, ending at the
+ * lowest-index step that finishes last, so the result is deterministic.
+ *
+ * @param exported The exported graph. Its `step_count`, `combined_step_links`
+ *        and `topological_order` are used.
+ * @param step_costs The estimated cost of each step, indexed by step index.
+ * @return Shared pointer to the analysis.
+ * @throw std::invalid_argument if step_costs does not have one finite,
+ *        non-negative entry per step, or if the links contain a cycle.
+ * @throw std::out_of_range if a link endpoint is not less than `exported.step_count`.
+ */
+std::shared_ptr<CriticalPathAnalysis> analyze_critical_path(const ExportedGraph& exported,
+                                                            const std::vector<double>& step_costs);
+
+} // namespace crddagt
@@ -0,0 +1,189 @@
+/**
+ * @file data_liveness.cpp
+ */
+#include "crddagt/common/data_liveness.hpp"
+
+#include <algorithm>
+
+namespace crddagt
+{
+
+std::shared_ptr<LivenessAnalysis> analyze_data_liveness(
+    const ExportedGraph& exported,
+    const std::vector<StepIdx>& order,
+    const std::unordered_map<std::type_index, size_t>& type_sizes)
+{
+    const size_t step_count = exported.step_count;
+    constexpr size_t not_in_order = std::numeric_limits<size_t>::max();
+
+    std::vector<size_t> position(step_count, not_in_order);
+    for (size_t p = 0; p < order.size(); ++p)
+    {
+        StepIdx s = order[p];
+        if (s >= step_count)
+        {
+            throw std::out_of_range("analyze_data_liveness: step " + std::to_string(s) +
+                                    " out of range [0, " + std::to_string(step_count) + ")");
+        }
+        if (position[s] != not_in_order)
+        {
+            throw std::invalid_argument("analyze_data_liveness: step " + std::to_string(s) +
+                                        " appears twice in the order");
+        }
+        position[s] = p;
+    }
+    for (const auto& [before, after] : exported.combined_step_links)
+    {
+        if (before >= step_count || after >= step_count)
+        {
+            throw std::out_of_range("analyze_data_liveness: link endpoint out of range");
+        }
+        if (position[before] != not_in_order && position[after] != not_in_order &&
+            position[before] > position[after])
+        {
+            throw std::invalid_argument(
+                "analyze_data_liveness: order runs step " + std::to_string(after) +
+                " before step " + std::to_string(before) + ", contradicting a link");
+        }
+    }
+
+    auto result = std::make_shared<LivenessAnalysis>();
+    LivenessAnalysis& a = *result;
+    a.order = order;
+    a.data.reserve(exported.data_infos.size());
+
+    // Intervals
+    for (const DataInfo& info : exported.data_infos)
+    {
+        DataLiveness live{0, 0, not_in_order, 0, false};
+        for (const auto& [sidx, fidx, usage] : info.field_usages)
+        {
+            if (sidx >= step_count)
+            {
+                throw std::out_of_range("analyze_data_liveness: step " + std::to_string(sidx) +
+                                        " out of range [0, " + std::to_string(step_count) + ")");
+            }
+            const size_t p = position[sidx];
+            if (p == not_in_order)
+            {
+                throw std::invalid_argument("analyze_data_liveness: step " + std::to_string(sidx) +
+                                            " uses data " + std::to_string(info.didx) +
+                                            " but is not in the order");
+            }
+            if (usage == Usage::Create)
+            {
+                live.create_step = sidx;
+                live.begin_position = p;
+            }
+            // A Destroy is always the last use; among Reads, the latest one is.
+            if (!live.is_destroyed && (p >= live.end_position || usage == Usage::Destroy))
+            {
+                live.last_use_step = sidx;
+                live.end_position = p;
+                live.is_destroyed = (usage == Usage::Destroy);
+            }
+        }
+        if (live.begin_position == not_in_order)
+        {
+            throw std::invalid_argument("analyze_data_liveness: data " +
+                                        std::to_string(info.didx) + " has no Create field");
+        }
+        a.data.push_back(live);
+    }
+
+    // Release lists: a counting sort of data objects by end position
+    a.release_offsets.assign(order.size() + 1, 0);
+    for (const DataLiveness& live : a.data)
+    {
+        ++a.release_offsets[live.end_position + 1];
+    }
+    for (size_t p = 0; p < order.size(); ++p)
+    {
+        a.release_offsets[p + 1] += a.release_offsets[p];
+    }
+    a.released_data.resize(a.data.size());
+    {
+        std::vector<size_t> cursor(a.release_offsets.begin(), a.release_offsets.end() - 1);
+        for (DataIdx d = 0; d < a.data.size(); ++d)
+        {
+            a.released_data[cursor[a.data[d].end_position]++] = d;
+        }
+    }
+
+    // Per-type slots, in order of first appearance
+    std::unordered_map<std::type_index, size_t> type_slot;
+    std::vector<size_t> data_type_slot(exported.data_infos.size());
+    for (DataIdx d = 0; d < exported.data_infos.size(); ++d)
+    {
+        const std::type_index ti = exported.data_infos[d].ti;
+        auto [it, inserted] = type_slot.emplace(ti, a.per_type.size());
+        if (inserted)
+        {
+            auto size_it = type_sizes.find(ti);
+            const size_t object_size = (size_it != type_sizes.end()) ? size_it->second : 0;
+            a.per_type.push_back(TypeLiveness{ti, object_size, 0, 0});
+        }
+        data_type_slot[d] = it->second;
+    }
+
+    // Sweep over positions. A data object created at p is counted at p; one
+    // last used at p is still counted at p and released afterwards.
+    std::vector<size_t> begin_offsets(order.size() + 1, 0);
+    for (const DataLiveness& live : a.data)
+    {
+        ++begin_offsets[live.begin_position + 1];
+    }
+    for (size_t p = 0; p < order.size(); ++p)
+    {
+        begin_offsets[p + 1] += begin_offsets[p];
+    }
+    std::vector<DataIdx> created_data(a.data.size());
+    {
+        std::vector<size_t> cursor(begin_offsets.begin(), begin_offsets.end() - 1);
+        for (DataIdx d = 0; d < a.data.size(); ++d)
+        {
+            created_data[cursor[a.data[d].begin_position]++] = d;
+        }
+    }
+
+    std::vector<size_t> type_live(a.per_type.size(), 0);
+    size_t live_count = 0;
+    size_t live_bytes = 0;
+    for (size_t p = 0; p < order.size(); ++p)
+    {
+        for (size_t i = begin_offsets[p]; i < begin_offsets[p + 1]; ++i)
+        {
+            TypeLiveness& type = a.per_type[data_type_slot[created_data[i]]];
+            ++live_count;
+            live_bytes += type.object_size;
+            size_t& count = type_live[data_type_slot[created_data[i]]];
+            ++count;
+            type.peak_live_count = std::max(type.peak_live_count, count);
+        }
+        if (live_count > a.peak_live_count)
+        {
+            a.peak_live_count = live_count;
+            a.peak_live_count_position = p;
+        }
+        if (live_bytes > a.peak_live_bytes)
+        {
+            a.peak_live_bytes = live_bytes;
+            a.peak_live_bytes_position = p;
+        }
+        for (size_t i = a.release_offsets[p]; i < a.release_offsets[p + 1]; ++i)
+        {
+            const size_t slot = data_type_slot[a.released_data[i]];
+            --live_count;
+            live_bytes -= a.per_type[slot].object_size;
+            --type_live[slot];
+        }
+    }
+    for (TypeLiveness& type : a.per_type)
+    {
+        type.peak_live_bytes = type.peak_live_count * type.object_size;
+    }
+
+    return result;
+}
+
+} // namespace crddagt
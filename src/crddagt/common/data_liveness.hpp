@@ -0,0 +1,118 @@
+/**
+ * @file data_liveness.hpp
+ * @brief Liveness of data objects over a sequential execution order.
+ */
+#pragma once
+#include "crddagt/common/common.hpp"
+#include "crddagt/common/graph_core_enums.hpp"
+#include "crddagt/common/exported_graph.hpp"
+
+namespace crddagt
+{
+
+/**
+ * @brief The live interval of one data object.
+ *
+ * @details
+ * Positions are indices into the execution order. The data object is live from
+ * the start of the step at `begin_position` through the end of the step at
+ * `end_position`, inclusive.
+ */
+struct DataLiveness
+{
+    /// The step that creates the data object.
+    StepIdx create_step;
+
+    /// The step after which the data object is dead: its destroying step if it
+    /// has one, otherwise the reader that runs last, otherwise the creating step.
+    StepIdx last_use_step;
+
+    /// Position of `create_step` in the order.
+    size_t begin_position;
+
+    /// Position of `last_use_step` in the order.
+    size_t end_position;
+
+    /// True if `last_use_step` destroys the data object.
+    bool is_destroyed;
+};
+
+/**
+ * @brief Peak liveness of the data objects of one type.
+ */
+struct TypeLiveness
+{
+    std::type_index ti;
+
+    /// The size of one object of this type, as supplied. 0 if not supplied.
+    size_t object_size;
+
+    /// The largest number of data objects of this type live at the same time.
+    size_t peak_live_count;
+
+    /// `peak_live_count * object_size`.
+    size_t peak_live_bytes;
+};
+
+/**
+ * @brief Liveness of all data objects of an exported graph over one order.
+ *
+ * @par Use for early release
+ * After the step at position p finishes, the data objects
+ * `released_data[release_offsets[p] .. release_offsets[p + 1])` are no longer
+ * needed by any later step in the order and can be freed or their buffers reused.
+ */
+struct LivenessAnalysis
+{
+    /// The execution order the analysis is based on.
+    std::vector<StepIdx> order;
+
+    /// The live interval of each data object, indexed by data object index.
+    std::vector<DataLiveness> data;
+
+    /// Offsets into `released_data`, one per position plus one.
+    std::vector<size_t> release_offsets;
+
+    /// Data objects grouped by the position of their last use.
+    std::vector<DataIdx> released_data;
+
+    /// The largest number of data objects live at the same time.
+    size_t peak_live_count = 0;
+
+    /// The first position at which `peak_live_count` is reached.
+    size_t peak_live_count_position = 0;
+
+    /// The largest total size of data objects live at the same time.
+    size_t peak_live_bytes = 0;
+
+    /// The first position at which `peak_live_bytes` is reached.
+    size_t peak_live_bytes_position = 0;
+
+    /// Peak liveness per type, in order of first appearance in `data_infos`.
+    std::vector<TypeLiveness> per_type;
+};
+
+/**
+ * @brief Computes the live interval of each data object over an execution order.
+ *
+ * Runs in O(V + E + F) for V steps, E combined step links and F fields.
+ *
+ * @param exported The exported graph.
+ * @param order The steps in the order they will run, typically
+ *        `exported.topological_order`. It must contain every step
+ *        that owns a field of a data object, and must be consistent with the
+ *        combined step links among the steps it contains. For a partial export,
+ *        `exported.topological_order` contains exactly the retained steps.
+ * @param type_sizes The size in bytes of one object of each type, for the byte
+ *        estimates. Types that are missing count as zero bytes.
+ * @return Shared pointer to the analysis.
+ * @throw std::invalid_argument if order repeats a step, leaves out a step that
+ *        uses data, contradicts a link, or a data object has no Create field.
+ * @throw std::out_of_range if a step index is not less than `exported.step_count`.
+ */
+std::shared_ptr<LivenessAnalysis> analyze_data_liveness(
+    const ExportedGraph& exported,
+    const std::vector<StepIdx>& order,
+    const std::unordered_map<std::type_index, size_t>& type_sizes = {});
+
+} // namespace crddagt
@@ -0,0 +1,78 @@
+/**
+ * @file executor_graph.cpp
+ */
+#include "crddagt/common/executor_graph.hpp"
+#include "crddagt/common/step_graph_algorithms.hpp"
+
+#include <algorithm>
+
+namespace crddagt
+{
+
+std::shared_ptr<ExecutorGraph> make_executor_graph(const ExportedGraph& exported)
+{
+    auto result = std::make_shared<ExecutorGraph>();
+    ExecutorGraph& g = *result;
+    const size_t step_count = exported.step_count;
+    g.step_count = step_count;
+
+    // Successors: bucket by before step, then sort and deduplicate each row,
+    // compacting the rows in place.
+    build_step_csr(step_count, exported.combined_step_links, g.successor_offsets, g.successors);
+    size_t write = 0;
+    for (StepIdx s = 0; s < step_count; ++s)
+    {
+        auto first = g.successors.begin() + g.successor_offsets[s];
+        auto last = g.successors.begin() + g.successor_offsets[s + 1];
+        std::sort(first, last);
+        auto unique_last = std::unique(first, last);
+        g.successor_offsets[s] = write;
+        write = static_cast<size_t>(std::move(first, unique_last, g.successors.begin() + write) -
+                                    g.successors.begin());
+    }
+    g.successor_offsets[step_count] = write;
+    g.successors.resize(write);
+    g.successors.shrink_to_fit();
+
+    // Predecessors: transpose. Visiting before steps in increasing order keeps
+    // each predecessor row sorted.
+    g.predecessor_offsets.assign(step_count + 1, 0);
+    for (StepIdx after : g.successors)
+    {
+        ++g.predecessor_offsets[after + 1];
+    }
+    for (StepIdx s = 0; s < step_count; ++s)
+    {
+        g.predecessor_offsets[s + 1] += g.predecessor_offsets[s];
+    }
+    g.predecessors.resize(g.successors.size());
+    std::vector<size_t> cursor(g.predecessor_offsets.begin(), g.predecessor_offsets.end() - 1);
+    for (StepIdx before = 0; before < step_count; ++before)
+    {
+        for (size_t i = g.successor_offsets[before]; i < g.successor_offsets[before + 1]; ++i)
+        {
+            g.predecessors[cursor[g.successors[i]]++] = before;
+        }
+    }
+
+    // Initial counts and sources; excluded steps must never be started
+    g.initial_predecessor_counts.resize(step_count);
+    for (StepIdx s = 0; s < step_count; ++s)
+    {
+        size_t count = g.predecessor_offsets[s + 1] - g.predecessor_offsets[s];
+        g.initial_predecessor_counts[s] = count;
+        if (exported.is_excluded_step(s))
+        {
+            continue;
+        }
+        ++g.runnable_step_count;
+        if (count == 0)
+        {
+            g.source_steps.push_back(s);
+        }
+    }
+
+    return result;
+}
+
+} // namespace crddagt
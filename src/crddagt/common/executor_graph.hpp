@@ -0,0 +1,84 @@
+/**
+ * @file executor_graph.hpp
+ */
+#pragma once
+#include "crddagt/common/common.hpp"
+#include "crddagt/common/graph_core_enums.hpp"
+#include "crddagt/common/exported_graph.hpp"
+
+namespace crddagt
+{
+
+/**
+ * @brief Step dependencies laid out for a dependency-counting scheduler.
+ *
+ * @details
+ * `ExecutorGraph` holds the combined step links of an `ExportedGraph` as
+ * deduplicated successor and predecessor lists in compressed sparse row (CSR)
+ * form, together with the initial dependency counts and the source steps.
+ *
+ * A typical scheduler copies `initial_predecessor_counts` into its own array of
+ * atomic counters, starts every step in `source_steps`, and when a step finishes,
+ * decrements the counter of each of its successors, starting those that reach zero.
+ * It is done once `runnable_step_count` steps have finished. Schedulers must use
+ * that count, not `step_count`, to detect completion: the graph of a
+ * `PartialExportedGraph` keeps its excluded steps in `step_count`, but they are
+ * never started.
+ *
+ * @par Layout
+ * - The successors of step s are `successors[successor_offsets[s] .. successor_offsets[s + 1])`.
+ * - The predecessors of step s are `predecessors[predecessor_offsets[s] .. predecessor_offsets[s + 1])`.
+ * - Both offset vectors have `step_count + 1` entries.
+ * - Within each list, step indices are strictly increasing (no duplicates).
+ *
+ * @par Thread safety
+ * - No internal synchronization.
+ * - Once constructed, the data is conceptually immutable.
+ * - Concurrent reads are safe.
+ */
+struct ExecutorGraph
+{
+    /// The number of steps, including steps excluded from a partial export.
+    size_t step_count = 0;
+
+    /// The number of steps a scheduler runs: `step_count` minus the steps
+    /// excluded from a partial export. Completion is reached when this many
+    /// steps have finished.
+    size_t runnable_step_count = 0;
+
+    /// CSR offsets into `successors`. Has `step_count + 1` entries.
+    std::vector<size_t> successor_offsets;
+
+    /// Successor steps, grouped by step.
+    std::vector<StepIdx> successors;
+
+    /// CSR offsets into `predecessors`. Has `step_count + 1` entries.
+    std::vector<size_t> predecessor_offsets;
+
+    /// Predecessor steps, grouped by step.
+    std::vector<StepIdx> predecessors;
+
+    /// For each step, the number of distinct predecessors that must finish first.
+    std::vector<size_t> initial_predecessor_counts;
+
+    /// Steps with no predecessors, in increasing index order. Steps excluded
+    /// from a partial export are not listed, so a scheduler never starts them.
+    std::vector<StepIdx> source_steps;
+};
+
+/**
+ * @brief Builds an `ExecutorGraph` from the combined step links of an exported graph.
+ *
+ * Runs in O(V + E log d) where d is the largest out-degree (for deduplication).
+ *
+ * @param exported The exported graph. Its `step_count` and `combined_step_links`
+ *        are used; the links may contain duplicates. For the graph of a
+ *        `PartialExportedGraph`, the excluded steps (see
+ *        `ExportedGraph::is_excluded_step()`) have no links, are left out
+ *        of `source_steps` and are not counted in `runnable_step_count`.
+ * @return Shared pointer to the executor graph.
+ * @throw std::out_of_range if a link endpoint is not less than `exported.step_count`.
+ */
+std::shared_ptr<ExecutorGraph> make_executor_graph(const ExportedGraph& exported);
+
+} // namespace crddagt
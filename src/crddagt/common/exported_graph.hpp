@@ -33,6 +33,70 @@ struct DataInfo
  */
 using StepLinkPair = std::pair<StepIdx, StepIdx>;
 
+/**
+ * @brief A read-only view of a contiguous array, in the manner of `std::span`.
+ *
+ * @details
+ * The view does not own the elements; it is invalidated when the underlying
+ * storage is resized or destroyed.
+ */
+template <typename T>
+class ConstArrayView
+{
+public:
+    using value_type = T;
+
+public:
+    ConstArrayView() = default;
+    ConstArrayView(const T* data, size_t size)
+        : m_data(data)
+        , m_size(size)
+    {
+    }
+
+    const T* data() const { return m_data; }
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    const T* begin() const { return m_data; }
+    const T* end() const { return m_data + m_size; }
+    const T& operator[](size_t i) const { return m_data[i]; }
+
+private:
+    const T* m_data = nullptr;
+    size_t m_size = 0;
+};
+
+/**
+ * @brief Value of `ExportedGraph::step_levels` for steps left out of a partial export.
+ */
+constexpr size_t excluded_step_level = std::numeric_limits<size_t>::max();
+
+// ============================================================================
+// ExportOptions
+// ============================================================================
+
+/**
+ * @brief Options controlling how `GraphCore` builds an `ExportedGraph`.
+ */
+struct ExportOptions
+{
+    /**
+     * @brief Replace `combined_step_links` with its transitive reduction.
+     *
+     * @details
+     * Executors pay per link for dependency counting and notification; the
+     * reduction keeps the same ordering constraints with the fewest links.
+     * See `reduce_step_links()`.
+     */
+    bool reduce_combined_step_links = false;
+
+    /**
+     * @brief Number of worker threads for parallel export work. 0 means
+     * hardware concurrency.
+     */
+    size_t num_threads = 0;
+};
+
 // ============================================================================
 // ExportedGraph
 // ============================================================================
@@ -71,13 +135,24 @@ using StepLinkPair = std::pair<StepIdx, StepIdx>;
  */
 struct ExportedGraph
 {
+    /**
+     * @brief The number of steps in the graph.
+     *
+     * @details
+     * Step indices in the link vectors are less than this. Steps that have no
+     * links at all appear only in this count.
+     */
+    size_t step_count = 0;
+
     /**
      * @brief The association of fields to data objects.
      *
      * @details
      * Each `FieldDataPair` is `(field_idx, data_object_idx)`. Fields that are
      * linked together share the same `data_object_idx`. Every field appears
-     * exactly once in this vector.
+     * exactly once in this vector, except in the graph of a
+     * `PartialExportedGraph`, where the excluded fields do not appear at all
+     * (see `PartialExportedGraph::excluded_fields`).
      */
     std::vector<FieldDataPair> field_data_pairs;
 
@@ -113,8 +188,178 @@ struct ExportedGraph
      * Each `StepLinkPair` is `(before_step_idx, after_step_idx)`. This is the
      * union of `implicit_step_links` and `explicit_step_links`, representing
      * all execution order constraints.
+     *
+     * If `ExportOptions::reduce_combined_step_links` was set, this is instead the
+     * transitive reduction of that union: duplicates and links implied by other
+     * paths are removed, and the remaining links are grouped by before step.
      */
     std::vector<StepLinkPair> combined_step_links;
+
+    /**
+     * @brief The number of links removed from `combined_step_links` by the
+     * transitive reduction. Zero if the reduction was not requested.
+     */
+    size_t eliminated_step_link_count = 0;
+
+    /**
+     * @brief All steps in an order consistent with `combined_step_links`.
+     *
+     * @details
+     * A single-threaded executor can run the steps in this order as-is. In the
+     * graph of a `PartialExportedGraph`, only the retained steps are listed;
+     * the steps for which `is_excluded_step()` is true are left out.
+     */
+    std::vector<StepIdx> topological_order;
+
+    /**
+     * @brief The level of each step, indexed by step index.
+     *
+     * @details
+     * The level is the length of the longest link path from a step without
+     * predecessors (level 0). Every link goes from a lower to a higher level,
+     * so all steps of one level may run concurrently once the previous levels
+     * are complete.
+     *
+     * In the graph of a `PartialExportedGraph`, the level of an excluded step
+     * is `excluded_step_level`, and such steps are not in `level_steps`. Test
+     * for it with `is_excluded_step()`.
+     */
+    std::vector<size_t> step_levels;
+
+    /**
+     * @brief Offsets into `level_steps`, one per level plus one.
+     *
+     * @details
+     * The steps of level k are `level_steps[level_offsets[k] .. level_offsets[k + 1])`.
+     * The number of levels is the length of the critical path in steps, and
+     * the size of each level is the parallelism available in that wavefront.
+     */
+    std::vector<size_t> level_offsets;
+
+    /**
+     * @brief All steps grouped by level, in increasing step index within each level.
+     *
+     * @details
+     * Steps excluded from a partial export are not listed.
+     */
+    std::vector<StepIdx> level_steps;
+
+    /**
+     * @brief True if step s was left out of a partial export.
+     *
+     * @details
+     * Read from `step_levels`; false for every step if `step_levels` is not filled.
+     */
+    bool is_excluded_step(StepIdx s) const
+    {
+        return s < step_levels.size() && step_levels[s] == excluded_step_level;
+    }
+};
+
+// ============================================================================
+// CompactExportedGraph
+// ============================================================================
+
+/**
+ * @brief An exported graph that stores each step link once.
+ *
+ * @details
+ * Produced by `GraphCore::export_compact_graph()`. It has the same content as
+ * an `ExportedGraph` without link reduction, except that the explicit, implicit
+ * and combined link lists are views into a single buffer:
+ *
+ *     step_links = [ explicit links | implicit links ]
+ *
+ * The combined links are the whole buffer, so they list the explicit links
+ * first, as `ExportedGraph::combined_step_links` does.
+ *
+ * @par Thread safety
+ * - No internal synchronization.
+ * - Once constructed, the data is conceptually immutable.
+ * - Views are invalidated if `step_links` is modified.
+ */
+struct CompactExportedGraph
+{
+    /// See `ExportedGraph::step_count`.
+    size_t step_count = 0;
+
+    /// See `ExportedGraph::field_data_pairs`.
+    std::vector<FieldDataPair> field_data_pairs;
+
+    /// See `ExportedGraph::data_infos`.
+    std::vector<DataInfo> data_infos;
+
+    /// All step links: the explicit links, then the implicit links.
+    std::vector<StepLinkPair> step_links;
+
+    /// The number of explicit links at the front of `step_links`.
+    size_t explicit_step_link_count = 0;
+
+    /// See `ExportedGraph::topological_order`.
+    std::vector<StepIdx> topological_order;
+
+    /// See `ExportedGraph::step_levels`.
+    std::vector<size_t> step_levels;
+
+    /// See `ExportedGraph::level_offsets`.
+    std::vector<size_t> level_offsets;
+
+    /// See `ExportedGraph::level_steps`.
+    std::vector<StepIdx> level_steps;
+
+    /// See `ExportedGraph::explicit_step_links`.
+    ConstArrayView<StepLinkPair> explicit_step_links() const
+    {
+        return ConstArrayView<StepLinkPair>(step_links.data(), explicit_step_link_count);
+    }
+
+    /// See `ExportedGraph::implicit_step_links`.
+    ConstArrayView<StepLinkPair> implicit_step_links() const
+    {
+        return ConstArrayView<StepLinkPair>(step_links.data() + explicit_step_link_count,
+                                            step_links.size() - explicit_step_link_count);
+    }
+
+    /// See `ExportedGraph::combined_step_links`.
+    ConstArrayView<StepLinkPair> combined_step_links() const
+    {
+        return ConstArrayView<StepLinkPair>(step_links.data(), step_links.size());
+    }
+};
+
+// ============================================================================
+// PartialExportedGraph
+// ============================================================================
+
+/**
+ * @brief The maximal valid subgraph of a graph that has errors.
+ *
+ * @details
+ * Produced by `GraphCore::export_valid_subgraph()`. The `graph` member can be
+ * executed as-is while the excluded region is being fixed. Step and field
+ * indices in `graph` are those of the original `GraphCore`, so the exclusion
+ * bitsets can be used to look up which of the caller's steps were left out.
+ *
+ * @par Thread safety
+ * - No internal synchronization.
+ * - Once constructed, the data is conceptually immutable.
+ */
+struct PartialExportedGraph
+{
+    /**
+     * @brief The export of the retained steps and fields.
+     */
+    ExportedGraph graph;
+
+    /**
+     * @brief Steps left out of `graph`. Indexed by step index.
+     */
+    std::vector<bool> excluded_steps;
+
+    /**
+     * @brief Fields left out of `graph`. Indexed by field index.
+     */
+    std::vector<bool> excluded_fields;
 };
 
 } // namespace crddagt
@@ -0,0 +1,450 @@
+/**
+ * @file exported_graph_io.cpp
+ */
+#include "crddagt/common/exported_graph_io.hpp"
+#include "crddagt/common/step_graph_algorithms.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#if defined(LINUX) || defined(MACOS)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace crddagt
+{
+
+using namespace exported_graph_format;
+
+namespace
+{
+
+constexpr size_t section_alignment = 8;
+
+size_t align_up(size_t n)
+{
+    return (n + section_alignment - 1) / section_alignment * section_alignment;
+}
+
+/// A section assembled in memory before writing.
+struct PendingSection
+{
+    SectionId id;
+    uint32_t element_size;
+    uint64_t count;
+    std::vector<unsigned char> bytes;
+};
+
+template <typename T>
+PendingSection make_section(SectionId id, const std::vector<T>& records)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "records must be trivially copyable");
+    PendingSection section{id, static_cast<uint32_t>(sizeof(T)), records.size(), {}};
+    section.bytes.resize(records.size() * sizeof(T));
+    if (!records.empty())
+    {
+        std::memcpy(section.bytes.data(), records.data(), section.bytes.size());
+    }
+    return section;
+}
+
+template <typename Index>
+PendingSection make_index_section(SectionId id, const std::vector<Index>& values)
+{
+    return make_section(id, std::vector<uint64_t>(values.begin(), values.end()));
+}
+
+PendingSection make_link_section(SectionId id, const std::vector<StepLinkPair>& links)
+{
+    std::vector<StoredStepLink> records;
+    records.reserve(links.size());
+    for (const auto& [before, after] : links)
+    {
+        records.push_back({before, after});
+    }
+    return make_section(id, records);
+}
+
+/// Narrows a stored value to size_t, for platforms where size_t is 32 bits.
+size_t to_size(uint64_t value)
+{
+    if (value > std::numeric_limits<size_t>::max())
+    {
+        throw std::runtime_error("MappedExportedGraph: value " + std::to_string(value) +
+                                 " does not fit in size_t");
+    }
+    return static_cast<size_t>(value);
+}
+
+} // namespace
+
+// ============================================================================
+// Writing
+// ============================================================================
+
+void write_exported_graph(const ExportedGraph& graph, std::ostream& out)
+{
+    std::vector<PendingSection> sections;
+
+    std::vector<StoredFieldData> field_data;
+    field_data.reserve(graph.field_data_pairs.size());
+    for (const auto& [fidx, didx] : graph.field_data_pairs)
+    {
+        field_data.push_back({fidx, didx});
+    }
+    sections.push_back(make_section(SectionId::FieldDataPairs, field_data));
+
+    std::vector<StoredDataInfo> infos;
+    std::vector<char> type_names;
+    std::vector<StoredFieldUsage> usages;
+    infos.reserve(graph.data_infos.size());
+    for (const DataInfo& info : graph.data_infos)
+    {
+        const char* name = info.ti.name();
+        const size_t name_size = std::strlen(name);
+        infos.push_back({info.didx, type_names.size(), name_size, usages.size(),
+                         info.field_usages.size()});
+        type_names.insert(type_names.end(), name, name + name_size);
+        for (const auto& [sidx, fidx, usage] : info.field_usages)
+        {
+            usages.push_back({sidx, fidx, static_cast<uint64_t>(usage)});
+        }
+    }
+    sections.push_back(make_section(SectionId::DataInfos, infos));
+    sections.push_back(make_section(SectionId::TypeNames, type_names));
+    sections.push_back(make_section(SectionId::FieldUsages, usages));
+
+    sections.push_back(make_link_section(SectionId::ImplicitStepLinks, graph.implicit_step_links));
+    sections.push_back(make_link_section(SectionId::ExplicitStepLinks, graph.explicit_step_links));
+    sections.push_back(make_link_section(SectionId::CombinedStepLinks, graph.combined_step_links));
+
+    std::vector<size_t> successor_offsets;
+    std::vector<StepIdx> successors;
+    build_step_csr(graph.step_count, graph.combined_step_links, successor_offsets, successors);
+    sections.push_back(make_index_section(SectionId::SuccessorOffsets, successor_offsets));
+    sections.push_back(make_index_section(SectionId::Successors, successors));
+
+    // excluded_step_level is stored as the maximum uint64_t on every platform
+    std::vector<uint64_t> step_levels;
+    step_levels.reserve(graph.step_levels.size());
+    for (size_t level : graph.step_levels)
+    {
+        step_levels.push_back(level == excluded_step_level ? std::numeric_limits<uint64_t>::max()
+                                                           : level);
+    }
+    sections.push_back(make_index_section(SectionId::TopologicalOrder, graph.topological_order));
+    sections.push_back(make_section(SectionId::StepLevels, step_levels));
+    sections.push_back(make_index_section(SectionId::LevelOffsets, graph.level_offsets));
+    sections.push_back(make_index_section(SectionId::LevelSteps, graph.level_steps));
+
+    FileHeader header{};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = format_version;
+    header.byte_order = byte_order_mark;
+    header.step_count = graph.step_count;
+    header.eliminated_step_link_count = graph.eliminated_step_link_count;
+    header.section_count = sections.size();
+
+    std::vector<SectionEntry> entries;
+    entries.reserve(sections.size());
+    size_t offset = align_up(sizeof(FileHeader) + sections.size() * sizeof(SectionEntry));
+    for (const PendingSection& section : sections)
+    {
+        entries.push_back({static_cast<uint32_t>(section.id), section.element_size, offset,
+                           section.count});
+        offset = align_up(offset + section.bytes.size());
+    }
+
+    static const char padding[section_alignment] = {};
+    size_t written = 0;
+    auto write_bytes = [&](const void* data, size_t size)
+    {
+        out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        written += size;
+    };
+    auto pad = [&]() { write_bytes(padding, align_up(written) - written); };
+
+    write_bytes(&header, sizeof(header));
+    write_bytes(entries.data(), entries.size() * sizeof(SectionEntry));
+    for (const PendingSection& section : sections)
+    {
+        pad();
+        write_bytes(section.bytes.data(), section.bytes.size());
+    }
+    pad();
+
+    if (!out)
+    {
+        throw std::runtime_error("write_exported_graph: stream write failed");
+    }
+}
+
+void save_exported_graph(const ExportedGraph& graph, const std::string& path)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+    {
+        throw std::runtime_error("save_exported_graph: cannot open " + path);
+    }
+    write_exported_graph(graph, out);
+    out.close();
+    if (!out)
+    {
+        throw std::runtime_error("save_exported_graph: cannot write " + path);
+    }
+}
+
+// ============================================================================
+// Reading
+// ============================================================================
+
+std::shared_ptr<MappedExportedGraph> MappedExportedGraph::open(const std::string& path)
+{
+    std::shared_ptr<MappedExportedGraph> result(new MappedExportedGraph());
+    result->parse(path);
+    return result;
+}
+
+MappedExportedGraph::~MappedExportedGraph()
+{
+#if defined(LINUX) || defined(MACOS)
+    if (m_is_mapped)
+    {
+        ::munmap(const_cast<unsigned char*>(m_bytes), m_size);
+    }
+#endif
+}
+
+void MappedExportedGraph::parse(const std::string& path)
+{
+    auto fail = [&](const std::string& what)
+    {
+        throw std::runtime_error("MappedExportedGraph: " + path + ": " + what);
+    };
+
+#if defined(LINUX) || defined(MACOS)
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        fail("cannot open");
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0)
+    {
+        ::close(fd);
+        fail("cannot stat");
+    }
+    m_size = static_cast<size_t>(st.st_size);
+    if (m_size >= sizeof(FileHeader))
+    {
+        void* addr = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED)
+        {
+            ::close(fd);
+            fail("cannot map");
+        }
+        m_bytes = static_cast<const unsigned char*>(addr);
+        m_is_mapped = true;
+    }
+    ::close(fd);
+#else
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in)
+    {
+        fail("cannot open");
+    }
+    m_size = static_cast<size_t>(in.tellg());
+    in.seekg(0);
+    m_buffer.resize(m_size);
+    if (!in.read(reinterpret_cast<char*>(m_buffer.data()), static_cast<std::streamsize>(m_size)))
+    {
+        fail("cannot read");
+    }
+    m_bytes = m_buffer.data();
+#endif
+
+    if (m_size < sizeof(FileHeader))
+    {
+        fail("file too small for header");
+    }
+    FileHeader header;
+    std::memcpy(&header, m_bytes, sizeof(header));
+    if (std::memcmp(header.magic, magic, sizeof(magic)) != 0)
+    {
+        fail("not an exported graph file");
+    }
+    if (header.byte_order != byte_order_mark)
+    {
+        fail("written on a machine of different byte order");
+    }
+    if (header.version != format_version)
+    {
+        fail("unsupported format version " + std::to_string(header.version));
+    }
+    m_step_count = to_size(header.step_count);
+    m_eliminated_step_link_count = to_size(header.eliminated_step_link_count);
+
+    if (header.section_count > (m_size - sizeof(FileHeader)) / sizeof(SectionEntry))
+    {
+        fail("section table exceeds file size");
+    }
+    const auto* entries = reinterpret_cast<const SectionEntry*>(m_bytes + sizeof(FileHeader));
+
+    auto find_section = [&](SectionId id, size_t element_size, const void*& data, size_t& count)
+    {
+        for (size_t i = 0; i < header.section_count; ++i)
+        {
+            const SectionEntry& entry = entries[i];
+            if (entry.id != static_cast<uint32_t>(id))
+            {
+                continue;
+            }
+            if (entry.element_size != element_size || entry.offset % section_alignment != 0 ||
+                entry.offset > m_size ||
+                entry.count > (m_size - entry.offset) / element_size)
+            {
+                fail("section " + std::to_string(entry.id) + " is malformed");
+            }
+            data = m_bytes + entry.offset;
+            count = to_size(entry.count);
+            return;
+        }
+        fail("missing section " + std::to_string(static_cast<uint32_t>(id)));
+    };
+    auto bind = [&](SectionId id, auto& view)
+    {
+        using T = typename std::decay_t<decltype(view)>::value_type;
+        const void* data = nullptr;
+        size_t count = 0;
+        find_section(id, sizeof(T), data, count);
+        view = StoredArrayView<T>(static_cast<const T*>(data), count);
+    };
+
+    bind(SectionId::FieldDataPairs, m_field_data_pairs);
+    bind(SectionId::DataInfos, m_data_infos);
+    bind(SectionId::TypeNames, m_type_names);
+    bind(SectionId::FieldUsages, m_field_usages);
+    bind(SectionId::ImplicitStepLinks, m_implicit_step_links);
+    bind(SectionId::ExplicitStepLinks, m_explicit_step_links);
+    bind(SectionId::CombinedStepLinks, m_combined_step_links);
+    bind(SectionId::SuccessorOffsets, m_successor_offsets);
+    bind(SectionId::Successors, m_successors);
+    bind(SectionId::TopologicalOrder, m_topological_order);
+    bind(SectionId::StepLevels, m_step_levels);
+    bind(SectionId::LevelOffsets, m_level_offsets);
+    bind(SectionId::LevelSteps, m_level_steps);
+
+    // Ranges that the accessors index without further checks
+    if (m_successor_offsets.size() != m_step_count + 1 ||
+        m_successor_offsets[m_step_count] != m_successors.size())
+    {
+        fail("successor offsets do not match the step count");
+    }
+    for (const StoredDataInfo& info : m_data_infos)
+    {
+        if (info.type_name_offset > m_type_names.size() ||
+            info.type_name_size > m_type_names.size() - info.type_name_offset ||
+            info.usage_offset > m_field_usages.size() ||
+            info.usage_count > m_field_usages.size() - info.usage_offset)
+        {
+            fail("data info " + std::to_string(info.didx) + " is out of range");
+        }
+    }
+}
+
+std::string_view MappedExportedGraph::type_name(const StoredDataInfo& info) const
+{
+    return std::string_view(m_type_names.data() + info.type_name_offset,
+                            static_cast<size_t>(info.type_name_size));
+}
+
+StoredArrayView<MappedExportedGraph::StoredFieldUsage>
+MappedExportedGraph::field_usages(const StoredDataInfo& info) const
+{
+    return StoredArrayView<StoredFieldUsage>(m_field_usages.data() + info.usage_offset,
+                                             static_cast<size_t>(info.usage_count));
+}
+
+std::shared_ptr<ExportedGraph>
+MappedExportedGraph::materialize(const std::vector<std::type_index>& known_types) const
+{
+    auto find_type = [&](std::string_view name) -> std::type_index
+    {
+        for (const std::type_index& ti : known_types)
+        {
+            if (name == ti.name())
+            {
+                return ti;
+            }
+        }
+        throw std::runtime_error("MappedExportedGraph: unknown type " + std::string(name));
+    };
+    auto copy_indices = [](StoredArrayView<uint64_t> view, auto& out)
+    {
+        out.clear();
+        out.reserve(view.size());
+        for (uint64_t value : view)
+        {
+            out.push_back(to_size(value));
+        }
+    };
+    auto copy_links = [](StoredArrayView<StoredStepLink> view, std::vector<StepLinkPair>& out)
+    {
+        out.clear();
+        out.reserve(view.size());
+        for (const StoredStepLink& link : view)
+        {
+            out.emplace_back(to_size(link.before), to_size(link.after));
+        }
+    };
+
+    auto result = std::make_shared<ExportedGraph>();
+    ExportedGraph& g = *result;
+    g.step_count = m_step_count;
+    g.eliminated_step_link_count = m_eliminated_step_link_count;
+
+    g.field_data_pairs.reserve(m_field_data_pairs.size());
+    for (const StoredFieldData& fd : m_field_data_pairs)
+    {
+        g.field_data_pairs.emplace_back(to_size(fd.field), to_size(fd.data));
+    }
+    g.data_infos.reserve(m_data_infos.size());
+    for (const StoredDataInfo& info : m_data_infos)
+    {
+        DataInfo& di = g.data_infos.emplace_back(
+            DataInfo{to_size(info.didx), find_type(type_name(info)), {}});
+        auto usages = field_usages(info);
+        di.field_usages.reserve(usages.size());
+        for (const StoredFieldUsage& u : usages)
+        {
+            if (u.usage > static_cast<uint64_t>(Usage::Destroy))
+            {
+                throw std::runtime_error("MappedExportedGraph: invalid usage value " +
+                                         std::to_string(u.usage));
+            }
+            di.field_usages.emplace_back(to_size(u.step), to_size(u.field),
+                                         static_cast<Usage>(u.usage));
+        }
+    }
+
+    copy_links(m_implicit_step_links, g.implicit_step_links);
+    copy_links(m_explicit_step_links, g.explicit_step_links);
+    copy_links(m_combined_step_links, g.combined_step_links);
+    copy_indices(m_topological_order, g.topological_order);
+    g.step_levels.reserve(m_step_levels.size());
+    for (uint64_t level : m_step_levels)
+    {
+        g.step_levels.push_back(level == std::numeric_limits<uint64_t>::max() ? excluded_step_level
+                                                                              : to_size(level));
+    }
+    copy_indices(m_level_offsets, g.level_offsets);
+    copy_indices(m_level_steps, g.level_steps);
+
+    return result;
+}
+
+} // namespace crddagt
@@ -0,0 +1,251 @@
+/**
+ * @file exported_graph_io.hpp
+ * @brief Binary file format for ExportedGraph, with a memory-mapped reader.
+ */
+#pragma once
+#include "crddagt/common/common.hpp"
+#include "crddagt/common/graph_core_enums.hpp"
+#include "crddagt/common/exported_graph.hpp"
+
+#include <iosfwd>
+#include <string_view>
+
+namespace crddagt
+{
+
+// ============================================================================
+// File format
+// ============================================================================
+
+/**
+ * @brief On-disk records of the exported graph file format.
+ *
+ * @details
+ * A file is a `FileHeader`, followed by `section_count` `SectionEntry` records,
+ * followed by the sections. Each section is an array of fixed-size records
+ * starting at an 8-byte aligned offset from the start of the file, so the file
+ * contains no pointers and can be mapped at any address.
+ *
+ * All integers are fixed-width and in the byte order of the writer; a reader
+ * with a different byte order rejects the file. Readers ignore sections with
+ * unknown ids, so sections can be added without a version bump; any other
+ * layout change increments `format_version`.
+ *
+ * Type identities are stored by name (`std::type_info::name()`), since a
+ * `std::type_index` has no meaning outside the process that created it.
+ */
+namespace exported_graph_format
+{
+
+/// The first eight bytes of every file.
+constexpr char magic[8] = {'C', 'R', 'D', 'D', 'A', 'G', 'T', 'G'};
+
+/// The current format version.
+constexpr uint32_t format_version = 1;
+
+/// Written as-is; reads back differently on a machine of the other byte order.
+constexpr uint32_t byte_order_mark = 0x01020304u;
+
+struct FileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t step_count;
+    uint64_t eliminated_step_link_count;
+    uint64_t section_count;
+};
+
+struct SectionEntry
+{
+    uint32_t id;
+    uint32_t element_size;
+    uint64_t offset;
+    uint64_t count;
+};
+
+enum class SectionId : uint32_t
+{
+    FieldDataPairs = 1,
+    DataInfos = 2,
+    TypeNames = 3,
+    FieldUsages = 4,
+    ImplicitStepLinks = 5,
+    ExplicitStepLinks = 6,
+    CombinedStepLinks = 7,
+    SuccessorOffsets = 8,
+    Successors = 9,
+    TopologicalOrder = 10,
+    StepLevels = 11,
+    LevelOffsets = 12,
+    LevelSteps = 13,
+};
+
+struct StoredFieldData
+{
+    uint64_t field;
+    uint64_t data;
+};
+
+/// One data object. Its type name and field usages are ranges into the
+/// `TypeNames` and `FieldUsages` sections.
+struct StoredDataInfo
+{
+    uint64_t didx;
+    uint64_t type_name_offset;
+    uint64_t type_name_size;
+    uint64_t usage_offset;
+    uint64_t usage_count;
+};
+
+struct StoredFieldUsage
+{
+    uint64_t step;
+    uint64_t field;
+    uint64_t usage; ///< The value of `Usage`.
+};
+
+struct StoredStepLink
+{
+    uint64_t before;
+    uint64_t after;
+};
+
+} // namespace exported_graph_format
+
+// ============================================================================
+// Writing
+// ============================================================================
+
+/**
+ * @brief Writes an exported graph in the binary format.
+ *
+ * Besides the members of `ExportedGraph`, the file holds the successor lists of
+ * `combined_step_links` in CSR form (see `build_step_csr()`), so that readers
+ * need not build them.
+ *
+ * @param graph The graph to write.
+ * @param out The output stream, which should be opened in binary mode.
+ * @throw std::out_of_range if a link endpoint is not less than `graph.step_count`.
+ * @throw std::runtime_error if the stream fails.
+ */
+void write_exported_graph(const ExportedGraph& graph, std::ostream& out);
+
+/**
+ * @brief Writes an exported graph to a file, replacing any existing file.
+ * @throw std::runtime_error if the file cannot be written.
+ */
+void save_exported_graph(const ExportedGraph& graph, const std::string& path);
+
+// ============================================================================
+// Reading
+// ============================================================================
+
+/**
+ * @brief A read-only view of a contiguous array of records in a mapped file.
+ */
+template <typename T>
+using StoredArrayView = ConstArrayView<T>;
+
+/**
+ * @brief An exported graph file, memory-mapped and accessed in place.
+ *
+ * @details
+ * Opening the file checks the header and that every section lies within the
+ * file, then exposes each section as a view into the mapping. Nothing is
+ * deserialized, so opening costs the same for any graph size, and pages are
+ * read in as they are touched. Index values in the sections are not checked;
+ * the file is trusted to come from `write_exported_graph()`.
+ *
+ * Where memory mapping is not available, the file is read into a buffer instead.
+ *
+ * @par Thread safety
+ * - No internal synchronization.
+ * - The mapping is read-only, so concurrent reads are safe.
+ * - All views are invalidated when the object is destroyed.
+ */
+class MappedExportedGraph
+{
+public:
+    using StoredFieldData = exported_graph_format::StoredFieldData;
+    using StoredDataInfo = exported_graph_format::StoredDataInfo;
+    using StoredFieldUsage = exported_graph_format::StoredFieldUsage;
+    using StoredStepLink = exported_graph_format::StoredStepLink;
+
+public:
+    /**
+     * @brief Maps the file at path.
+     * @throw std::runtime_error if the file cannot be read or is not a valid
+     *        file of a supported version.
+     */
+    static std::shared_ptr<MappedExportedGraph> open(const std::string& path);
+
+    ~MappedExportedGraph();
+    MappedExportedGraph(const MappedExportedGraph&) = delete;
+    MappedExportedGraph& operator=(const MappedExportedGraph&) = delete;
+
+public:
+    size_t step_count() const { return m_step_count; }
+    size_t eliminated_step_link_count() const { return m_eliminated_step_link_count; }
+
+    StoredArrayView<StoredFieldData> field_data_pairs() const { return m_field_data_pairs; }
+    StoredArrayView<StoredDataInfo> data_infos() const { return m_data_infos; }
+    StoredArrayView<StoredStepLink> implicit_step_links() const { return m_implicit_step_links; }
+    StoredArrayView<StoredStepLink> explicit_step_links() const { return m_explicit_step_links; }
+    StoredArrayView<StoredStepLink> combined_step_links() const { return m_combined_step_links; }
+
+    /// CSR offsets into `successors()`. Has `step_count() + 1` entries.
+    StoredArrayView<uint64_t> successor_offsets() const { return m_successor_offsets; }
+    StoredArrayView<uint64_t> successors() const { return m_successors; }
+
+    StoredArrayView<uint64_t> topological_order() const { return m_topological_order; }
+    /// Excluded steps of a partial export have the maximum `uint64_t` level.
+    StoredArrayView<uint64_t> step_levels() const { return m_step_levels; }
+    StoredArrayView<uint64_t> level_offsets() const { return m_level_offsets; }
+    StoredArrayView<uint64_t> level_steps() const { return m_level_steps; }
+
+    /// The `std::type_info::name()` of the data object's type.
+    std::string_view type_name(const StoredDataInfo& info) const;
+
+    /// The (step, field, usage) entries of the data object.
+    StoredArrayView<StoredFieldUsage> field_usages(const StoredDataInfo& info) const;
+
+    /**
+     * @brief Copies the file contents into a new `ExportedGraph`.
+     *
+     * @param known_types The types that may appear in the file. Each data
+     *        object's type is found by name among these.
+     * @return Shared pointer to the graph.
+     * @throw std::runtime_error if a data object's type is not in known_types,
+     *        or if a value does not fit in `size_t`.
+     */
+    std::shared_ptr<ExportedGraph> materialize(const std::vector<std::type_index>& known_types) const;
+
+private:
+    MappedExportedGraph() = default;
+    void parse(const std::string& path);
+
+private:
+    const unsigned char* m_bytes = nullptr;
+    size_t m_size = 0;
+    bool m_is_mapped = false;
+    std::vector<unsigned char> m_buffer;
+
+    size_t m_step_count = 0;
+    size_t m_eliminated_step_link_count = 0;
+    StoredArrayView<StoredFieldData> m_field_data_pairs;
+    StoredArrayView<StoredDataInfo> m_data_infos;
+    StoredArrayView<char> m_type_names;
+    StoredArrayView<StoredFieldUsage> m_field_usages;
+    StoredArrayView<StoredStepLink> m_implicit_step_links;
+    StoredArrayView<StoredStepLink> m_explicit_step_links;
+    StoredArrayView<StoredStepLink> m_combined_step_links;
+    StoredArrayView<uint64_t> m_successor_offsets;
+    StoredArrayView<uint64_t> m_successors;
+    StoredArrayView<uint64_t> m_topological_order;
+    StoredArrayView<uint64_t> m_step_levels;
+    StoredArrayView<uint64_t> m_level_offsets;
+    StoredArrayView<uint64_t> m_level_steps;
+};
+
+} // namespace crddagt
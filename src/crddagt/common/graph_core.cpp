@@ -3,14 +3,62 @@
  */
 #include "crddagt/common/graph_core.hpp"
 #include "crddagt/common/iterable_union_find.inline.hpp"
+#include "crddagt/common/concurrent_union_find.inline.hpp"
+#include "crddagt/common/parallel_chunks.hpp"
+#include "crddagt/common/step_graph_algorithms.hpp"
 
 #include <algorithm>
-#include <queue>
 #include <unordered_set>
 
 namespace crddagt
 {
 
+namespace
+{
+
+// ----------------------------------------------------------------------------
+// Structural hash helpers. Each component is a sum of well-mixed terms, so it
+// is independent of the order in which the terms were added.
+// ----------------------------------------------------------------------------
+
+/// The splitmix64 finalizer.
+uint64_t mix64(uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+uint64_t hash_combine(uint64_t seed, uint64_t value)
+{
+    return mix64(seed ^ mix64(value));
+}
+
+/// FNV-1a over the type name, which is stable across processes.
+uint64_t hash_type(std::type_index ti)
+{
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (const char* p = ti.name(); *p != '\0'; ++p)
+    {
+        h = (h ^ static_cast<unsigned char>(*p)) * 0x100000001b3ull;
+    }
+    return h;
+}
+
+/// Distinct seeds keep the components from cancelling one another.
+constexpr uint64_t field_hash_seed = 0x6669656c64ull;      // "field"
+constexpr uint64_t member_hash_seed = 0x6d656d626572ull;   // "member"
+constexpr uint64_t class_hash_seed = 0x636c617373ull;      // "class"
+constexpr uint64_t link_hash_seed = 0x6c696e6bull;         // "link"
+
+uint64_t hash_class_members(uint64_t member_sum)
+{
+    return hash_combine(class_hash_seed, member_sum);
+}
+
+} // namespace
+
 // ============================================================================
 // Constructor
 // ============================================================================
@@ -20,6 +68,43 @@ GraphCore::GraphCore(bool eager_validation)
 {
 }
 
+void GraphCore::clear() noexcept
+{
+    // Per-step lists are emptied but not removed, so add_step() reuses them
+    for (StepIdx sidx = 0; sidx < m_step_count; ++sidx)
+    {
+        m_step_fields[sidx].clear();
+        m_step_successors[sidx].clear();
+        m_step_successor_origins[sidx].clear();
+    }
+    m_step_count = 0;
+
+    m_field_count = 0;
+    m_field_owner_step.clear();
+    m_field_types.clear();
+    m_field_usages.clear();
+
+    m_explicit_step_links.clear();
+    m_explicit_step_link_trust.clear();
+
+    m_field_uf.clear();
+    m_field_links.clear();
+    m_field_link_trust.clear();
+
+    m_field_hash_sum = 0;
+    m_field_partition_hash_sum = 0;
+    m_explicit_link_hash_sum = 0;
+    m_field_class_hash.clear();
+
+    // The reachability workspace needs no reset: stale marks carry older epochs
+}
+
+void GraphCore::reset(bool eager_validation) noexcept
+{
+    clear();
+    m_eager_validation = eager_validation;
+}
+
 // ============================================================================
 // Query methods
 // ============================================================================
@@ -34,6 +119,14 @@ size_t GraphCore::field_count() const noexcept
     return m_field_count;
 }
 
+uint64_t GraphCore::structural_hash() const noexcept
+{
+    uint64_t h = hash_combine(m_step_count, m_field_count);
+    h = hash_combine(h, m_field_hash_sum);
+    h = hash_combine(h, m_field_partition_hash_sum);
+    return hash_combine(h, m_explicit_link_hash_sum);
+}
+
 // ============================================================================
 // Step and field management
 // ============================================================================
@@ -54,8 +147,13 @@ void GraphCore::add_step(size_t step_idx)
                 std::to_string(m_step_count));
     }
 
-    m_step_fields.emplace_back();
-    m_step_successors.emplace_back();
+    // Lists past m_step_count are left over from clear(), already empty
+    if (m_step_fields.size() == m_step_count)
+    {
+        m_step_fields.emplace_back();
+        m_step_successors.emplace_back();
+        m_step_successor_origins.emplace_back();
+    }
     ++m_step_count;
 }
 
@@ -93,7 +191,16 @@ void GraphCore::add_field(size_t step_idx, size_t field_idx, std::type_index ti,
     m_field_usages.push_back(usage);
 
     // Initialize union-find for this field (each field starts as its own singleton set)
-    m_field_uf.make_set();
+    m_field_uf.make_set(FieldUsageCounts::of(usage));
+
+    // Update the structural hash; the field starts as a singleton class
+    uint64_t field_hash = hash_combine(field_hash_seed, field_idx);
+    field_hash = hash_combine(field_hash, step_idx);
+    field_hash = hash_combine(field_hash, hash_type(ti));
+    m_field_hash_sum += hash_combine(field_hash, static_cast<uint64_t>(usage));
+    uint64_t member_hash = hash_combine(member_hash_seed, field_idx);
+    m_field_class_hash.push_back(member_hash);
+    m_field_partition_hash_sum += hash_class_members(member_hash);
 
     ++m_field_count;
 }
@@ -132,21 +239,22 @@ void GraphCore::link_steps(size_t step_before_idx, size_t step_after_idx, TrustL
     {
         if (is_reachable_from(step_after_idx, step_before_idx))
         {
-            throw GraphCoreError(
-                GraphCoreErrorCode::CycleDetected,
+            throw_cycle_detected(
+                step_before_idx, step_after_idx,
                 "Adding edge " + std::to_string(step_before_idx) + " -> " +
-                    std::to_string(step_after_idx) +
-                    " would create a cycle (step " + std::to_string(step_before_idx) +
-                    " is reachable from step " + std::to_string(step_after_idx) + ")");
+                    std::to_string(step_after_idx) + " would create a cycle");
         }
     }
 
     // Store the link
     m_explicit_step_links.emplace_back(step_before_idx, step_after_idx);
     m_explicit_step_link_trust.push_back(trust);
+    m_explicit_link_hash_sum +=
+        hash_combine(hash_combine(link_hash_seed, step_before_idx), step_after_idx);
 
     // Update step successors adjacency list for future cycle checks
-    m_step_successors[step_before_idx].push_back(step_after_idx);
+    add_step_successor(step_before_idx, step_after_idx,
+                       StepEdgeOrigin{true, m_explicit_step_links.size() - 1});
 }
 
 // ============================================================================
@@ -201,29 +309,12 @@ void GraphCore::link_fields(size_t field_one_idx, size_t field_two_idx, TrustLev
     // Eager validation: check usage constraints and cycles before merging
     if (m_eager_validation)
     {
-        // Collect all fields in each equivalence class
-        std::vector<FieldIdx> class_one;
-        std::vector<FieldIdx> class_two;
-        m_field_uf.get_class_members(field_one_idx, class_one);
-        m_field_uf.get_class_members(field_two_idx, class_two);
-
-        // Count Creates and Destroys in each class
-        size_t creates_one = 0, destroys_one = 0;
-        size_t creates_two = 0, destroys_two = 0;
-
-        for (FieldIdx f : class_one)
-        {
-            if (m_field_usages[f] == Usage::Create) ++creates_one;
-            else if (m_field_usages[f] == Usage::Destroy) ++destroys_one;
-        }
-        for (FieldIdx f : class_two)
-        {
-            if (m_field_usages[f] == Usage::Create) ++creates_two;
-            else if (m_field_usages[f] == Usage::Destroy) ++destroys_two;
-        }
+        // Create and Destroy counts are kept per class by the union-find
+        const FieldUsageCounts& counts_one = m_field_uf.class_aggregate(root_one);
+        const FieldUsageCounts& counts_two = m_field_uf.class_aggregate(root_two);
 
         // Check for multiple Creates
-        if (creates_one + creates_two > 1)
+        if (counts_one.creates + counts_two.creates > 1)
         {
             throw GraphCoreError(
                 GraphCoreErrorCode::MultipleCreate,
@@ -231,13 +322,19 @@ void GraphCore::link_fields(size_t field_one_idx, size_t field_two_idx, TrustLev
         }
 
         // Check for multiple Destroys
-        if (destroys_one + destroys_two > 1)
+        if (counts_one.destroys + counts_two.destroys > 1)
         {
             throw GraphCoreError(
                 GraphCoreErrorCode::MultipleDestroy,
                 "Linking fields would result in multiple Destroy fields for same data");
         }
 
+        // Collect all fields in each equivalence class
+        std::vector<FieldIdx> class_one;
+        std::vector<FieldIdx> class_two;
+        m_field_uf.get_class_members(field_one_idx, class_one);
+        m_field_uf.get_class_members(field_two_idx, class_two);
+
         // Check for self-aliasing: same step with incompatible usages across the merge
         // Build map of step -> usages from the merged class
         std::unordered_map<StepIdx, std::vector<Usage>> merged_step_usages;
@@ -299,12 +396,12 @@ void GraphCore::link_fields(size_t field_one_idx, size_t field_two_idx, TrustLev
                     // Check if this creates a cycle
                     if (is_reachable_from(after, before))
                     {
-                        throw GraphCoreError(
-                            GraphCoreErrorCode::CycleDetected,
+                        throw_cycle_detected(
+                            before, after,
                             "Linking fields would create a cycle: implicit edge " +
                                 std::to_string(before) + " -> " + std::to_string(after) +
-                                " conflicts with existing path from " +
-                                std::to_string(after) + " to " + std::to_string(before));
+                                " (fields " + std::to_string(fa) + " and " +
+                                std::to_string(fb) + ") conflicts with existing path");
                     }
 
                     new_edges.push_back(edge.value());
@@ -313,9 +410,10 @@ void GraphCore::link_fields(size_t field_one_idx, size_t field_two_idx, TrustLev
         }
 
         // All checks passed; add the new implicit edges to step successors
+        // The link being added will be stored at m_field_links.size()
         for (const auto& [before, after] : new_edges)
         {
-            m_step_successors[before].push_back(after);
+            add_step_successor(before, after, StepEdgeOrigin{false, m_field_links.size()});
         }
     }
 
@@ -325,6 +423,100 @@ void GraphCore::link_fields(size_t field_one_idx, size_t field_two_idx, TrustLev
 
     // Unite equivalence classes
     m_field_uf.unite(field_one_idx, field_two_idx);
+
+    // Replace the two classes with the merged one in the partition hash
+    uint64_t merged_hash = m_field_class_hash[root_one] + m_field_class_hash[root_two];
+    m_field_partition_hash_sum -= hash_class_members(m_field_class_hash[root_one]) +
+                                  hash_class_members(m_field_class_hash[root_two]);
+    m_field_partition_hash_sum += hash_class_members(merged_hash);
+    m_field_class_hash[m_field_uf.find(field_one_idx)] = merged_hash;
+}
+
+void GraphCore::link_fields_parallel(const std::vector<std::pair<FieldIdx, FieldIdx>>& links,
+                                     TrustLevel trust,
+                                     size_t num_threads)
+{
+    if (m_eager_validation)
+    {
+        throw GraphCoreError(
+            GraphCoreErrorCode::InvalidState,
+            "link_fields_parallel requires deferred validation");
+    }
+
+    // Check everything first, so that nothing is applied on failure
+    size_t stored_count = 0;
+    for (const auto& [field_one_idx, field_two_idx] : links)
+    {
+        for (FieldIdx fidx : {field_one_idx, field_two_idx})
+        {
+            if (fidx >= m_field_count)
+            {
+                throw GraphCoreError(
+                    GraphCoreErrorCode::InvalidFieldIndex,
+                    "Field index " + std::to_string(fidx) + " does not exist");
+            }
+        }
+        if (m_field_types[field_one_idx] != m_field_types[field_two_idx])
+        {
+            throw GraphCoreError(
+                GraphCoreErrorCode::TypeMismatch,
+                "Cannot link fields with different types: field " +
+                    std::to_string(field_one_idx) + " (" +
+                    m_field_types[field_one_idx].name() + ") and field " +
+                    std::to_string(field_two_idx) + " (" +
+                    m_field_types[field_two_idx].name() + ")");
+        }
+        if (field_one_idx != field_two_idx)
+        {
+            ++stored_count;
+        }
+    }
+
+    std::vector<FieldIdx> old_roots;
+    m_field_uf.get_roots(old_roots);
+    ConcurrentUnionFind<FieldIdx> concurrent_uf(m_field_uf);
+
+    // Workers claim fixed-size chunks of links
+    run_in_chunks(links.size(), num_threads, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            concurrent_uf.unite(links[i].first, links[i].second);
+        }
+    });
+
+    // Record the links as link_fields() would; self-links are not stored
+    m_field_links.reserve(m_field_links.size() + stored_count);
+    m_field_link_trust.reserve(m_field_link_trust.size() + stored_count);
+    for (const auto& [field_one_idx, field_two_idx] : links)
+    {
+        if (field_one_idx != field_two_idx)
+        {
+            m_field_links.emplace_back(field_one_idx, field_two_idx);
+            m_field_link_trust.push_back(trust);
+        }
+    }
+    concurrent_uf.export_to(m_field_uf, [this](FieldIdx fidx)
+                            { return FieldUsageCounts::of(m_field_usages[fidx]); });
+
+    // Replace each old class in the partition hash by the new class containing it
+    std::vector<uint64_t> new_class_hash(m_field_count, 0);
+    for (FieldIdx fidx = 0; fidx < m_field_count; ++fidx)
+    {
+        if (old_roots[fidx] == fidx)
+        {
+            m_field_partition_hash_sum -= hash_class_members(m_field_class_hash[fidx]);
+            new_class_hash[m_field_uf.class_root(fidx)] += m_field_class_hash[fidx];
+        }
+    }
+    for (FieldIdx fidx = 0; fidx < m_field_count; ++fidx)
+    {
+        if (m_field_uf.class_root(fidx) == fidx)
+        {
+            m_field_class_hash[fidx] = new_class_hash[fidx];
+            m_field_partition_hash_sum += hash_class_members(new_class_hash[fidx]);
+        }
+    }
 }
 
 // ============================================================================
@@ -354,83 +546,296 @@ std::optional<std::pair<StepIdx, StepIdx>> GraphCore::get_implicit_edge(
     }
 }
 
-bool GraphCore::is_reachable_from(StepIdx from, StepIdx target) const
+void GraphCore::add_step_successor(StepIdx before, StepIdx after, StepEdgeOrigin origin)
+{
+    m_step_successors[before].push_back(after);
+    m_step_successor_origins[before].push_back(origin);
+}
+
+bool GraphCore::is_reachable_from(StepIdx from, StepIdx target)
 {
     if (from == target)
     {
         return true;
     }
 
-    // Iterative DFS
-    std::vector<bool> visited(m_step_count, false);
-    std::vector<StepIdx> stack;
+    // Reuse the workspace: bumping the epoch unmarks all steps in O(1)
+    if (m_reach_mark.size() < m_step_count)
+    {
+        m_reach_mark.resize(m_step_count, 0);
+        m_reach_parent.resize(m_step_count);
+        m_reach_parent_edge.resize(m_step_count);
+    }
+    if (++m_reach_epoch == 0)
+    {
+        std::fill(m_reach_mark.begin(), m_reach_mark.end(), 0);
+        m_reach_epoch = 1;
+    }
+
+    // Iterative DFS. Steps are marked when first pushed, so each parent
+    // pointer is written exactly once per search.
+    std::vector<StepIdx>& stack = m_reach_stack;
+    stack.clear();
     stack.push_back(from);
+    m_reach_mark[from] = m_reach_epoch;
 
     while (!stack.empty())
     {
         StepIdx current = stack.back();
         stack.pop_back();
 
-        if (visited[current])
-        {
-            continue;
-        }
-        visited[current] = true;
-
-        for (StepIdx successor : m_step_successors[current])
+        const std::vector<StepIdx>& successors = m_step_successors[current];
+        for (size_t i = 0; i < successors.size(); ++i)
         {
+            StepIdx successor = successors[i];
+            if (m_reach_mark[successor] == m_reach_epoch)
+            {
+                continue;
+            }
+            m_reach_mark[successor] = m_reach_epoch;
+            m_reach_parent[successor] = current;
+            m_reach_parent_edge[successor] = i;
             if (successor == target)
             {
                 return true;
             }
-            if (!visited[successor])
+            stack.push_back(successor);
+        }
+    }
+
+    return false;
+}
+
+void GraphCore::get_reach_path(StepIdx from, StepIdx target,
+                               std::vector<StepIdx>& out_steps,
+                               std::vector<CycleLink>& out_links) const
+{
+    out_steps.clear();
+    out_links.clear();
+
+    // Walk parent pointers back from target, then reverse
+    out_steps.push_back(target);
+    for (StepIdx s = target; s != from;)
+    {
+        StepIdx parent = m_reach_parent[s];
+        const StepEdgeOrigin& origin = m_step_successor_origins[parent][m_reach_parent_edge[s]];
+
+        CycleLink link{parent, s, origin.is_explicit, origin.link_index};
+        if (!origin.is_explicit)
+        {
+            // Recover a pair of fields inducing this edge. The class that
+            // contains the link's fields now is a superset of the class it
+            // joined, so such a pair is always present.
+            std::vector<FieldIdx> members;
+            m_field_uf.get_class_members(m_field_links[origin.link_index].first, members);
+            for (FieldIdx fa : members)
             {
-                stack.push_back(successor);
+                if (m_field_owner_step[fa] != parent)
+                {
+                    continue;
+                }
+                for (FieldIdx fb : members)
+                {
+                    if (m_field_owner_step[fb] == s &&
+                        static_cast<int>(m_field_usages[fa]) < static_cast<int>(m_field_usages[fb]))
+                    {
+                        link.before_field = fa;
+                        link.after_field = fb;
+                        break;
+                    }
+                }
+                if (link.after_field != std::numeric_limits<FieldIdx>::max())
+                {
+                    break;
+                }
             }
         }
+        out_links.push_back(link);
+        out_steps.push_back(parent);
+        s = parent;
     }
+    std::reverse(out_steps.begin(), out_steps.end());
+    std::reverse(out_links.begin(), out_links.end());
+}
 
-    return false;
+void GraphCore::throw_cycle_detected(StepIdx before, StepIdx after, const std::string& what) const
+{
+    std::vector<StepIdx> path;
+    std::vector<CycleLink> links;
+    get_reach_path(after, before, path, links);
+
+    std::string message = what + "; existing path: ";
+    for (size_t i = 0; i < path.size(); ++i)
+    {
+        if (i > 0)
+        {
+            const CycleLink& link = links[i - 1];
+            message += link.is_explicit
+                ? " -(step link " + std::to_string(link.link_index) + ")-> "
+                : " -(fields " + std::to_string(link.before_field) + ", " +
+                      std::to_string(link.after_field) + ")-> ";
+        }
+        message += std::to_string(path[i]);
+    }
+
+    throw GraphCoreError(GraphCoreErrorCode::CycleDetected, std::move(message),
+                         std::move(path), std::move(links));
 }
 
 // ============================================================================
 // Diagnostics and export
 // ============================================================================
 
+void GraphCore::build_field_classes(FieldClassBuckets& out) const
+{
+    // Dense class indices in order of lowest field, then fields grouped by
+    // class; both linear, without hashing or a copy of m_field_uf.
+    m_field_uf.relabel_dense(out.field_class);
+    m_field_uf.export_classes_csr(out.field_class, out.class_offsets, out.class_members);
+}
+
+void GraphCore::append_implicit_step_links(const FieldClassBuckets& classes,
+                                           const std::vector<bool>* excluded_fields,
+                                           std::vector<StepLinkPair>& out) const
+{
+    std::vector<StepIdx> create_steps;
+    std::vector<StepIdx> read_steps;
+    std::vector<StepIdx> destroy_steps;
+
+    // For each data object, order steps by usage: Create < Read < Destroy
+    for (DataIdx cidx = 0; cidx < classes.class_count(); ++cidx)
+    {
+        create_steps.clear();
+        read_steps.clear();
+        destroy_steps.clear();
+
+        for (size_t i = classes.class_offsets[cidx]; i < classes.class_offsets[cidx + 1]; ++i)
+        {
+            FieldIdx fidx = classes.class_members[i];
+            if (excluded_fields && (*excluded_fields)[fidx])
+            {
+                continue;
+            }
+            StepIdx sidx = m_field_owner_step[fidx];
+            switch (m_field_usages[fidx])
+            {
+            case Usage::Create:
+                create_steps.push_back(sidx);
+                break;
+            case Usage::Read:
+                read_steps.push_back(sidx);
+                break;
+            case Usage::Destroy:
+                destroy_steps.push_back(sidx);
+                break;
+            }
+        }
+
+        // Create -> Read
+        for (StepIdx cs : create_steps)
+        {
+            for (StepIdx rs : read_steps)
+            {
+                if (cs != rs)
+                {
+                    out.emplace_back(cs, rs);
+                }
+            }
+        }
+
+        // Create -> Destroy
+        for (StepIdx cs : create_steps)
+        {
+            for (StepIdx ds : destroy_steps)
+            {
+                if (cs != ds)
+                {
+                    out.emplace_back(cs, ds);
+                }
+            }
+        }
+
+        // Read -> Destroy
+        for (StepIdx rs : read_steps)
+        {
+            for (StepIdx ds : destroy_steps)
+            {
+                if (rs != ds)
+                {
+                    out.emplace_back(rs, ds);
+                }
+            }
+        }
+    }
+}
+
 std::shared_ptr<GraphCoreDiagnostics> GraphCore::get_diagnostics(bool treat_as_sealed) const
 {
     auto diagnostics = std::make_shared<GraphCoreDiagnostics>();
+    get_diagnostics_into(*diagnostics, treat_as_sealed);
+    return diagnostics;
+}
 
-    // =========================================================================
-    // Phase 1: Build equivalence classes and collect field info per data object
-    // =========================================================================
-
-    // Make a mutable so we can optimize it for repeated finds.
-    IterableUnionFind<FieldIdx> field_uf{m_field_uf};
+void GraphCore::get_diagnostics_into(GraphCoreDiagnostics& out, bool treat_as_sealed) const
+{
+    out.m_errors.clear();
+    out.m_warnings.clear();
 
-    // Map from root field index to list of (field_idx, step_idx, usage)
-    std::unordered_map<FieldIdx, std::vector<std::tuple<FieldIdx, StepIdx, Usage>>> equiv_classes;
+    FieldClassBuckets classes;
+    build_field_classes(classes);
+    collect_diagnostics(classes, treat_as_sealed, out);
+}
 
-    for (FieldIdx fidx = 0; fidx < m_field_count; ++fidx)
+void GraphCore::collect_diagnostics(const FieldClassBuckets& classes,
+                                    bool treat_as_sealed,
+                                    GraphCoreDiagnostics& out,
+                                    std::vector<StepIdx>* out_topological_order) const
+{
+    if (out_topological_order)
     {
-        FieldIdx root = field_uf.find(fidx);
-        equiv_classes[root].emplace_back(fidx, m_field_owner_step[fidx], m_field_usages[fidx]);
+        out_topological_order->clear();
     }
 
+    const size_t class_count = classes.class_count();
+
+    // =========================================================================
+    // Phase 1: Equivalence classes are provided by build_field_classes()
+    // =========================================================================
+
+    // Returns the (field_idx, step_idx, usage) of each member of class c,
+    // in increasing field index order.
+    auto class_fields = [&](DataIdx cidx, std::vector<std::tuple<FieldIdx, StepIdx, Usage>>& fields)
+    {
+        fields.clear();
+        for (size_t i = classes.class_offsets[cidx]; i < classes.class_offsets[cidx + 1]; ++i)
+        {
+            FieldIdx fidx = classes.class_members[i];
+            fields.emplace_back(fidx, m_field_owner_step[fidx], m_field_usages[fidx]);
+        }
+    };
+
     // =========================================================================
     // Phase 2: Usage constraint validation per equivalence class
     // =========================================================================
 
-    for (const auto& [root, fields] : equiv_classes)
+    std::vector<std::tuple<FieldIdx, StepIdx, Usage>> fields;
+    std::vector<std::tuple<StepIdx, FieldIdx, Usage>> step_usages;
+
+    for (DataIdx cidx = 0; cidx < class_count; ++cidx)
     {
+        class_fields(cidx, fields);
+
         std::vector<FieldIdx> create_fields;
         std::vector<FieldIdx> destroy_fields;
         std::vector<FieldIdx> read_fields;
-        std::unordered_map<StepIdx, std::vector<std::pair<FieldIdx, Usage>>> step_usages;
+
+        // (step, field, usage) sorted by step, so that usages of the same
+        // step for this data object are adjacent.
+        step_usages.clear();
 
         for (const auto& [fidx, sidx, usage] : fields)
         {
-            step_usages[sidx].emplace_back(fidx, usage);
+            step_usages.emplace_back(sidx, fidx, usage);
 
             switch (usage)
             {
@@ -460,8 +865,8 @@ std::shared_ptr<GraphCoreDiagnostics> GraphCore::get_diagnostics(bool treat_as_s
                 item.involved_steps.push_back(m_field_owner_step[f]);
             }
             // Blame analysis: find field links involved, order by trust
-            add_field_link_blame(field_uf, item, create_fields);
-            diagnostics->m_errors.push_back(std::move(item));
+            add_field_link_blame(item, create_fields);
+            out.m_errors.push_back(std::move(item));
         }
 
         // Check: Multiple Destroys
@@ -476,8 +881,8 @@ std::shared_ptr<GraphCoreDiagnostics> GraphCore::get_diagnostics(bool treat_as_s
             {
                 item.involved_steps.push_back(m_field_owner_step[f]);
             }
-            add_field_link_blame(field_uf, item, destroy_fields);
-            diagnostics->m_errors.push_back(std::move(item));
+            add_field_link_blame(item, destroy_fields);
+            out.m_errors.push_back(std::move(item));
         }
 
         // Check: Missing Create (any Read or Destroy without a Create)
@@ -500,29 +905,37 @@ std::shared_ptr<GraphCoreDiagnostics> GraphCore::get_diagnostics(bool treat_as_s
             {
                 all_fields.push_back(fidx);
             }
-            add_field_link_blame(field_uf, item, all_fields);
+            add_field_link_blame(item, all_fields);
             if (treat_as_sealed)
             {
-                diagnostics->m_errors.push_back(std::move(item));
+                out.m_errors.push_back(std::move(item));
             }
             else
             {
-                diagnostics->m_warnings.push_back(std::move(item));
+                out.m_warnings.push_back(std::move(item));
             }
         }
 
         // Check: Self-aliasing (same step has incompatible usages for same data)
         // Multiple Reads on the same step for the same data are allowed.
         // Disallowed combinations: Create+Read, Create+Destroy, Read+Destroy
-        for (const auto& [sidx, usages] : step_usages)
+        std::sort(step_usages.begin(), step_usages.end());
+        for (size_t group_begin = 0; group_begin < step_usages.size();)
         {
-            if (usages.size() > 1)
+            StepIdx sidx = std::get<0>(step_usages[group_begin]);
+            size_t group_end = group_begin + 1;
+            while (group_end < step_usages.size() && std::get<0>(step_usages[group_end]) == sidx)
+            {
+                ++group_end;
+            }
+
+            if (group_end - group_begin > 1)
             {
                 // Check if all usages are Read - that's allowed
                 bool all_reads = true;
-                for (const auto& [fidx, usage] : usages)
+                for (size_t i = group_begin; i < group_end; ++i)
                 {
-                    if (usage != Usage::Read)
+                    if (std::get<2>(step_usages[i]) != Usage::Read)
                     {
                         all_reads = false;
                         break;
@@ -538,14 +951,16 @@ std::shared_ptr<GraphCoreDiagnostics> GraphCore::get_diagnostics(bool treat_as_s
                     item.message = "Self-aliasing: step " + std::to_string(sidx) +
                                    " has incompatible field usages for same data object";
                     item.involved_steps.push_back(sidx);
-                    for (const auto& [fidx, usage] : usages)
+                    for (size_t i = group_begin; i < group_end; ++i)
                     {
-                        item.involved_fields.push_back(fidx);
+                        item.involved_fields.push_back(std::get<1>(step_usages[i]));
                     }
-                    add_field_link_blame(field_uf, item, item.involved_fields);
-                    diagnostics->m_errors.push_back(std::move(item));
+                    add_field_link_blame(item, item.involved_fields);
+                    out.m_errors.push_back(std::move(item));
                 }
             }
+
+            group_begin = group_end;
         }
     }
 
@@ -573,19 +988,20 @@ std::shared_ptr<GraphCoreDiagnostics> GraphCore::get_diagnostics(bool treat_as_s
             item.category = DiagnosticCategory::OrphanStep;
             item.message = "Step " + std::to_string(sidx) + " has no fields and no links";
             item.involved_steps.push_back(sidx);
-            diagnostics->m_warnings.push_back(std::move(item));
+            out.m_warnings.push_back(std::move(item));
         }
     }
 
     // Singleton equivalence classes: handle based on usage type
     // - Singleton Create → UnusedData warning (data created but never consumed)
     // - Singleton Read/Destroy → MissingCreate (handled in Phase 2 condition fix)
-    for (const auto& [root, fields] : equiv_classes)
+    for (DataIdx cidx = 0; cidx < class_count; ++cidx)
     {
-        if (fields.size() == 1)
+        if (classes.class_offsets[cidx + 1] - classes.class_offsets[cidx] == 1)
         {
-            const auto& [fidx, sidx, usage] = fields[0];
-            if (usage == Usage::Create)
+            FieldIdx fidx = classes.class_members[classes.class_offsets[cidx]];
+            StepIdx sidx = m_field_owner_step[fidx];
+            if (m_field_usages[fidx] == Usage::Create)
             {
                 // Singleton Create = data created but never consumed
                 DiagnosticItem item;
@@ -595,7 +1011,7 @@ std::shared_ptr<GraphCoreDiagnostics> GraphCore::get_diagnostics(bool treat_as_s
                                " has no consumers (no Read or Destroy)";
                 item.involved_fields.push_back(fidx);
                 item.involved_steps.push_back(sidx);
-                diagnostics->m_warnings.push_back(std::move(item));
+                out.m_warnings.push_back(std::move(item));
             }
             // Singleton Read/Destroy are handled by MissingCreate detection
             // (after Phase 2 condition fix)
@@ -610,64 +1026,7 @@ std::shared_ptr<GraphCoreDiagnostics> GraphCore::get_diagnostics(bool treat_as_s
     std::vector<StepLinkPair> combined_links = m_explicit_step_links;
 
     // Add implicit links from usage ordering
-    for (const auto& [root, fields] : equiv_classes)
-    {
-        std::vector<StepIdx> create_steps;
-        std::vector<StepIdx> read_steps;
-        std::vector<StepIdx> destroy_steps;
-
-        for (const auto& [fidx, sidx, usage] : fields)
-        {
-            switch (usage)
-            {
-            case Usage::Create:
-                create_steps.push_back(sidx);
-                break;
-            case Usage::Read:
-                read_steps.push_back(sidx);
-                break;
-            case Usage::Destroy:
-                destroy_steps.push_back(sidx);
-                break;
-            }
-        }
-
-        // Create -> Read
-        for (StepIdx cs : create_steps)
-        {
-            for (StepIdx rs : read_steps)
-            {
-                if (cs != rs)
-                {
-                    combined_links.emplace_back(cs, rs);
-                }
-            }
-        }
-
-        // Create -> Destroy
-        for (StepIdx cs : create_steps)
-        {
-            for (StepIdx ds : destroy_steps)
-            {
-                if (cs != ds)
-                {
-                    combined_links.emplace_back(cs, ds);
-                }
-            }
-        }
-
-        // Read -> Destroy
-        for (StepIdx rs : read_steps)
-        {
-            for (StepIdx ds : destroy_steps)
-            {
-                if (rs != ds)
-                {
-                    combined_links.emplace_back(rs, ds);
-                }
-            }
-        }
-    }
+    append_implicit_step_links(classes, nullptr, combined_links);
 
     // Kahn's algorithm for cycle detection
     if (m_step_count > 0)
@@ -681,35 +1040,39 @@ std::shared_ptr<GraphCoreDiagnostics> GraphCore::get_diagnostics(bool treat_as_s
             ++in_degree[after];
         }
 
-        std::queue<StepIdx> ready;
+        // The ready queue is a vector consumed from the front, so that it
+        // ends up holding the topological order.
+        std::vector<StepIdx> local_order;
+        std::vector<StepIdx>& ready = out_topological_order ? *out_topological_order : local_order;
+        ready.clear();
+        ready.reserve(m_step_count);
         for (StepIdx s = 0; s < m_step_count; ++s)
         {
             if (in_degree[s] == 0)
             {
-                ready.push(s);
+                ready.push_back(s);
             }
         }
 
-        size_t processed = 0;
-        while (!ready.empty())
+        for (size_t head = 0; head < ready.size(); ++head)
         {
-            StepIdx s = ready.front();
-            ready.pop();
-            ++processed;
-
+            StepIdx s = ready[head];
             for (StepIdx succ : successors[s])
             {
                 --in_degree[succ];
                 if (in_degree[succ] == 0)
                 {
-                    ready.push(succ);
+                    ready.push_back(succ);
                 }
             }
         }
+        size_t processed = ready.size();
 
         // If not all steps were processed, there's a cycle
         if (processed < m_step_count)
         {
+            ready.clear();
+
             DiagnosticItem item;
             item.severity = DiagnosticSeverity::Error;
             item.category = DiagnosticCategory::Cycle;
@@ -727,15 +1090,13 @@ std::shared_ptr<GraphCoreDiagnostics> GraphCore::get_diagnostics(bool treat_as_s
             // Blame analysis: find explicit step links involved in cycle
             add_step_link_blame(item, item.involved_steps);
 
-            diagnostics->m_errors.push_back(std::move(item));
+            out.m_errors.push_back(std::move(item));
         }
     }
 
-    return diagnostics;
 }
 
-void GraphCore::add_field_link_blame(IterableUnionFind<FieldIdx>& field_uf,
-                                     DiagnosticItem& item,
+void GraphCore::add_field_link_blame(DiagnosticItem& item,
                                      const std::vector<FieldIdx>& involved_fields) const
 {
     // Find field links that connect any of the involved fields
@@ -746,10 +1107,6 @@ void GraphCore::add_field_link_blame(IterableUnionFind<FieldIdx>& field_uf,
     for (size_t i = 0; i < m_field_links.size(); ++i)
     {
         const auto& [f1, f2] = m_field_links[i];
-        // Check if this link connects two fields in the involved set
-        // or connects a field in the set to another in the same equivalence class
-        FieldIdx root1 = field_uf.find(f1);
-        FieldIdx root2 = field_uf.find(f2);
         bool f1_involved = field_set.count(f1) > 0;
         bool f2_involved = field_set.count(f2) > 0;
 
@@ -802,143 +1159,322 @@ void GraphCore::add_step_link_blame(DiagnosticItem& item,
     }
 }
 
-std::shared_ptr<ExportedGraph> GraphCore::export_graph() const
+std::shared_ptr<ExportedGraph> GraphCore::export_graph(const ExportOptions& options) const
+{
+    auto exported = std::make_shared<ExportedGraph>();
+    export_graph_into(*exported, options);
+    return exported;
+}
+
+void GraphCore::export_graph_into(ExportedGraph& out, const ExportOptions& options) const
 {
+    // Each equivalence class becomes a data object; the dense class index
+    // is used directly as the data object index.
+    FieldClassBuckets classes;
+    build_field_classes(classes);
+
     // Check diagnostics with treat_as_sealed=true since export implies completion
-    auto diagnostics = get_diagnostics(true);
-    if (!diagnostics->is_valid())
+    // Kahn's algorithm in the cycle check also yields the topological order
+    GraphCoreDiagnostics diagnostics;
+    collect_diagnostics(classes, true, diagnostics, &out.topological_order);
+    if (!diagnostics.is_valid())
+    {
+        throw GraphCoreError(
+            GraphCoreErrorCode::InvalidState,
+            "Cannot export graph with unresolved errors");
+    }
+
+    // Clear everything else, keeping capacity; data_infos entries are
+    // reused in place by fill_data_objects().
+    out.field_data_pairs.clear();
+    out.implicit_step_links.clear();
+    out.explicit_step_links.clear();
+    out.combined_step_links.clear();
+    out.eliminated_step_link_count = 0;
+    fill_exported_graph(classes, nullptr, nullptr, false, options, out);
+}
+
+std::shared_ptr<ExportedGraph> GraphCore::into_exported(const ExportOptions& options) &&
+{
+    FieldClassBuckets classes;
+    build_field_classes(classes);
+
+    GraphCoreDiagnostics diagnostics;
+    std::vector<StepIdx> topological_order;
+    collect_diagnostics(classes, true, diagnostics, &topological_order);
+    if (!diagnostics.is_valid())
     {
         throw GraphCoreError(
             GraphCoreErrorCode::InvalidState,
             "Cannot export graph with unresolved errors");
     }
 
+    // Nothing below throws GraphCoreError; from here on the builder is consumed.
     auto exported = std::make_shared<ExportedGraph>();
+    exported->topological_order = std::move(topological_order);
+    exported->explicit_step_links = std::move(m_explicit_step_links);
+    fill_exported_graph(classes, nullptr, nullptr, true, options, *exported);
 
-    // Make a mutable so we can optimize it for repeated finds.
-    IterableUnionFind<FieldIdx> field_uf{m_field_uf};
+    // The remaining per-link state no longer matches the moved links
+    clear();
+    return exported;
+}
 
-    // Build field-to-data mapping using union-find
-    // Each equivalence class root becomes a data object index
-    std::unordered_map<FieldIdx, DataIdx> root_to_data;
-    DataIdx next_data_idx = 0;
+std::shared_ptr<CompactExportedGraph> GraphCore::export_compact_graph() const
+{
+    FieldClassBuckets classes;
+    build_field_classes(classes);
 
-    for (FieldIdx fidx = 0; fidx < m_field_count; ++fidx)
+    auto exported = std::make_shared<CompactExportedGraph>();
+    GraphCoreDiagnostics diagnostics;
+    collect_diagnostics(classes, true, diagnostics, &exported->topological_order);
+    if (!diagnostics.is_valid())
     {
-        FieldIdx root = field_uf.find(fidx);
-        auto it = root_to_data.find(root);
-        if (it == root_to_data.end())
+        throw GraphCoreError(
+            GraphCoreErrorCode::InvalidState,
+            "Cannot export graph with unresolved errors");
+    }
+
+    exported->step_count = m_step_count;
+    fill_data_objects(classes, nullptr, exported->field_data_pairs, exported->data_infos);
+
+    // One buffer: explicit links, then implicit links
+    exported->step_links = m_explicit_step_links;
+    exported->explicit_step_link_count = m_explicit_step_links.size();
+    append_implicit_step_links(classes, nullptr, exported->step_links);
+    exported->step_links.shrink_to_fit();
+
+    compute_step_levels(m_step_count, exported->step_links, exported->topological_order,
+                        exported->step_levels);
+    group_steps_by_level(exported->step_levels, exported->level_offsets, exported->level_steps);
+    return exported;
+}
+
+std::shared_ptr<PartialExportedGraph> GraphCore::export_valid_subgraph(
+    const ExportOptions& options) const
+{
+    FieldClassBuckets classes;
+    build_field_classes(classes);
+
+    GraphCoreDiagnostics diagnostics;
+    collect_diagnostics(classes, true, diagnostics);
+
+    auto partial = std::make_shared<PartialExportedGraph>();
+    partial->excluded_steps.assign(m_step_count, false);
+    partial->excluded_fields.assign(m_field_count, false);
+    std::vector<bool>& excluded_steps = partial->excluded_steps;
+    std::vector<bool>& excluded_fields = partial->excluded_fields;
+
+    // Seed: every step touched by an error, directly or through one of its fields.
+    // Cycle errors already include the steps downstream of the cycle.
+    std::vector<StepIdx> pending;
+    auto exclude_step = [&](StepIdx sidx)
+    {
+        if (!excluded_steps[sidx])
         {
-            root_to_data[root] = next_data_idx;
-            ++next_data_idx;
+            excluded_steps[sidx] = true;
+            pending.push_back(sidx);
+        }
+    };
+    for (const DiagnosticItem& item : diagnostics.errors())
+    {
+        for (StepIdx sidx : item.involved_steps)
+        {
+            exclude_step(sidx);
+        }
+        for (FieldIdx fidx : item.involved_fields)
+        {
+            exclude_step(m_field_owner_step[fidx]);
         }
-        DataIdx didx = root_to_data[root];
-        exported->field_data_pairs.emplace_back(fidx, didx);
     }
 
-    // Build data_infos - use a map for construction since DataInfo has no default ctor
-    std::unordered_map<DataIdx, DataInfo> data_info_map;
-
-    for (FieldIdx fidx = 0; fidx < m_field_count; ++fidx)
+    // Propagate downstream along explicit and implicit links: a step that runs
+    // after an excluded step cannot be executed either.
+    if (!pending.empty())
     {
-        FieldIdx root = field_uf.find(fidx);
-        DataIdx didx = root_to_data[root];
-        StepIdx sidx = m_field_owner_step[fidx];
-        Usage usage = m_field_usages[fidx];
+        std::vector<StepLinkPair> combined_links = m_explicit_step_links;
+        append_implicit_step_links(classes, nullptr, combined_links);
 
-        auto it = data_info_map.find(didx);
-        if (it == data_info_map.end())
+        std::vector<std::vector<StepIdx>> successors(m_step_count);
+        for (const auto& [before, after] : combined_links)
         {
-            // First field for this data object - use aggregate initialization
-            DataInfo info{didx, m_field_types[fidx], {}};
-            info.field_usages.emplace_back(sidx, fidx, usage);
-            data_info_map.emplace(didx, std::move(info));
+            successors[before].push_back(after);
         }
-        else
+
+        while (!pending.empty())
         {
-            it->second.field_usages.emplace_back(sidx, fidx, usage);
+            StepIdx sidx = pending.back();
+            pending.pop_back();
+            for (StepIdx succ : successors[sidx])
+            {
+                exclude_step(succ);
+            }
         }
     }
 
-    // Convert map to vector, sorted by DataIdx
-    exported->data_infos.reserve(next_data_idx);
-    for (DataIdx d = 0; d < next_data_idx; ++d)
+    // A field is excluded together with its owning step
+    for (FieldIdx fidx = 0; fidx < m_field_count; ++fidx)
     {
-        exported->data_infos.push_back(std::move(data_info_map.at(d)));
+        excluded_fields[fidx] = excluded_steps[m_field_owner_step[fidx]];
     }
 
-    // Copy explicit step links
-    exported->explicit_step_links = m_explicit_step_links;
+    fill_exported_graph(classes, &excluded_steps, &excluded_fields, false, options,
+                        partial->graph);
+    return partial;
+}
 
-    // Build implicit step links from field usage ordering
-    // For each data object, order steps by usage: Create < Read < Destroy
-    for (const auto& data_info : exported->data_infos)
+void GraphCore::fill_data_objects(const FieldClassBuckets& classes,
+                                  const std::vector<bool>* excluded_fields,
+                                  std::vector<FieldDataPair>& out_field_data_pairs,
+                                  std::vector<DataInfo>& out_data_infos) const
+{
+    auto is_excluded_field = [&](FieldIdx fidx)
     {
-        std::vector<StepIdx> create_steps;
-        std::vector<StepIdx> read_steps;
-        std::vector<StepIdx> destroy_steps;
-
-        for (const auto& [sidx, fidx, usage] : data_info.field_usages)
+        return excluded_fields && (*excluded_fields)[fidx];
+    };
+
+    // Data objects are numbered densely over the classes that keep at least
+    // one field; without exclusions this is the class index itself.
+    constexpr DataIdx unassigned = std::numeric_limits<DataIdx>::max();
+    std::vector<DataIdx> class_to_data;
+    DataIdx data_count = classes.class_count();
+    if (excluded_fields)
+    {
+        class_to_data.assign(classes.class_count(), unassigned);
+        data_count = 0;
+        for (FieldIdx fidx = 0; fidx < m_field_count; ++fidx)
         {
-            switch (usage)
+            DataIdx cidx = classes.field_class[fidx];
+            if (!is_excluded_field(fidx) && class_to_data[cidx] == unassigned)
             {
-            case Usage::Create:
-                create_steps.push_back(sidx);
-                break;
-            case Usage::Read:
-                read_steps.push_back(sidx);
-                break;
-            case Usage::Destroy:
-                destroy_steps.push_back(sidx);
-                break;
+                class_to_data[cidx] = data_count++;
             }
         }
+    }
+    auto data_of_class = [&](DataIdx cidx)
+    {
+        return excluded_fields ? class_to_data[cidx] : cidx;
+    };
 
-        // Create -> Read links
-        for (StepIdx create_step : create_steps)
+    // Build field-to-data mapping
+    out_field_data_pairs.reserve(m_field_count);
+    for (FieldIdx fidx = 0; fidx < m_field_count; ++fidx)
+    {
+        if (!is_excluded_field(fidx))
         {
-            for (StepIdx read_step : read_steps)
-            {
-                if (create_step != read_step)
-                {
-                    exported->implicit_step_links.emplace_back(create_step, read_step);
-                }
-            }
+            out_field_data_pairs.emplace_back(fidx, data_of_class(classes.field_class[fidx]));
         }
+    }
 
-        // Create -> Destroy links
-        for (StepIdx create_step : create_steps)
+    // Build data_infos in DataIdx order. Entries already present in
+    // out_data_infos are overwritten in place to reuse their capacity.
+    out_data_infos.reserve(data_count);
+    for (DataIdx cidx = 0; cidx < classes.class_count(); ++cidx)
+    {
+        DataIdx didx = data_of_class(cidx);
+        if (didx == unassigned)
+        {
+            continue;
+        }
+        size_t begin = classes.class_offsets[cidx];
+        size_t end = classes.class_offsets[cidx + 1];
+        std::type_index ti = m_field_types[classes.class_members[begin]];
+        if (didx < out_data_infos.size())
         {
-            for (StepIdx destroy_step : destroy_steps)
+            out_data_infos[didx].didx = didx;
+            out_data_infos[didx].ti = ti;
+            out_data_infos[didx].field_usages.clear();
+        }
+        else
+        {
+            out_data_infos.push_back(DataInfo{didx, ti, {}});
+        }
+        auto& field_usages = out_data_infos[didx].field_usages;
+        field_usages.reserve(end - begin);
+        for (size_t i = begin; i < end; ++i)
+        {
+            FieldIdx fidx = classes.class_members[i];
+            if (!is_excluded_field(fidx))
             {
-                if (create_step != destroy_step)
-                {
-                    exported->implicit_step_links.emplace_back(create_step, destroy_step);
-                }
+                field_usages.emplace_back(m_field_owner_step[fidx], fidx, m_field_usages[fidx]);
             }
         }
+    }
+    // Drop entries left over from a larger previous export
+    out_data_infos.erase(out_data_infos.begin() + data_count, out_data_infos.end());
+}
+
+void GraphCore::fill_exported_graph(const FieldClassBuckets& classes,
+                                    const std::vector<bool>* excluded_steps,
+                                    const std::vector<bool>* excluded_fields,
+                                    bool explicit_step_links_given,
+                                    const ExportOptions& options,
+                                    ExportedGraph& out) const
+{
+    // out.topological_order is taken as given if it is already filled.
+    out.step_count = m_step_count;
+
+    fill_data_objects(classes, excluded_fields, out.field_data_pairs, out.data_infos);
 
-        // Read -> Destroy links
-        for (StepIdx read_step : read_steps)
+    // Copy explicit step links between retained steps
+    if (excluded_steps)
+    {
+        for (const auto& [before, after] : m_explicit_step_links)
         {
-            for (StepIdx destroy_step : destroy_steps)
+            if (!(*excluded_steps)[before] && !(*excluded_steps)[after])
             {
-                if (read_step != destroy_step)
-                {
-                    exported->implicit_step_links.emplace_back(read_step, destroy_step);
-                }
+                out.explicit_step_links.emplace_back(before, after);
             }
         }
     }
+    else if (!explicit_step_links_given)
+    {
+        out.explicit_step_links = m_explicit_step_links;
+    }
+
+    // Build implicit step links from field usage ordering
+    append_implicit_step_links(classes, excluded_fields, out.implicit_step_links);
 
     // Build combined links (union of explicit and implicit)
-    exported->combined_step_links = exported->explicit_step_links;
-    exported->combined_step_links.insert(
-        exported->combined_step_links.end(),
-        exported->implicit_step_links.begin(),
-        exported->implicit_step_links.end());
+    out.combined_step_links.reserve(out.explicit_step_links.size() +
+                                    out.implicit_step_links.size());
+    out.combined_step_links.assign(out.explicit_step_links.begin(),
+                                   out.explicit_step_links.end());
+    out.combined_step_links.insert(
+        out.combined_step_links.end(),
+        out.implicit_step_links.begin(),
+        out.implicit_step_links.end());
+
+    // Topological order and levels. The full export reuses the order from
+    // the diagnostics pass; the retained part of a partial export is acyclic
+    // and is sorted here, with excluded steps then dropped from the order.
+    if (out.topological_order.size() != m_step_count)
+    {
+        topological_sort(m_step_count, out.combined_step_links, out.topological_order);
+    }
+    compute_step_levels(m_step_count, out.combined_step_links, out.topological_order,
+                        out.step_levels);
+    if (excluded_steps)
+    {
+        auto is_excluded = [&](StepIdx sidx) { return (*excluded_steps)[sidx]; };
+        out.topological_order.erase(
+            std::remove_if(out.topological_order.begin(), out.topological_order.end(), is_excluded),
+            out.topological_order.end());
+        for (StepIdx sidx = 0; sidx < m_step_count; ++sidx)
+        {
+            if (is_excluded(sidx))
+            {
+                out.step_levels[sidx] = excluded_step_level;
+            }
+        }
+    }
+    group_steps_by_level(out.step_levels, out.level_offsets, out.level_steps);
 
-    return exported;
+    if (options.reduce_combined_step_links)
+    {
+        out.eliminated_step_link_count =
+            reduce_step_links(m_step_count, out.combined_step_links, options.num_threads);
+    }
 }
 
 } // namespace crddagt
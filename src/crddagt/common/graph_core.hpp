@@ -58,6 +58,23 @@ public:
      */
     explicit GraphCore(bool eager_validation = true);
 
+    /**
+     * @brief Remove all steps, fields and links, keeping allocated capacity.
+     *
+     * @details
+     * Afterwards the graph is empty, as if newly constructed with the same
+     * validation mode. Internal buffers keep their capacity, including the
+     * per-step lists of fields and successors, so rebuilding a graph of similar
+     * shape does not reallocate them.
+     */
+    void clear() noexcept;
+
+    /**
+     * @brief Same as `clear()`, and also change the validation mode.
+     * @param eager_validation See the constructor.
+     */
+    void reset(bool eager_validation) noexcept;
+
     /**
      * @brief Get the current number of steps in the graph.
      * @return The count of steps added via `add_step()`.
@@ -70,6 +87,24 @@ public:
      */
     size_t field_count() const noexcept;
 
+    /**
+     * @brief Get a structural fingerprint of the graph, for caching exports.
+     *
+     * @details
+     * The hash covers the step count, each field's owning step, type and usage,
+     * the partition of fields into data objects, and the multiset of explicit
+     * step links. It does not depend on the order or redundancy of
+     * `link_fields()` calls, nor on trust levels or the validation mode, so two
+     * instances that describe the same graph have the same hash.
+     *
+     * The hash is maintained incrementally by the mutators, so this is O(1).
+     * It is stable across processes built with the same compiler, since types
+     * are hashed by `std::type_info::name()`.
+     *
+     * @return A 64-bit hash. Different graphs collide with probability about 2^-64.
+     */
+    uint64_t structural_hash() const noexcept;
+
     /**
      * @brief Add a step to the graph.
      * @param step_idx Index of the step to add. Must equal the current `step_count()`.
@@ -120,6 +155,30 @@ public:
      */
     void link_fields(size_t field_one_idx, size_t field_two_idx, TrustLevel trust);
 
+    /**
+     * @brief Link many pairs of fields at once, merging classes on several threads.
+     *
+     * @details
+     * Equivalent to calling `link_fields()` for each pair in order, with the
+     * same trust level. All pairs are checked before any is applied, so on an
+     * exception the graph is unchanged. The merges then run on a concurrent
+     * union-find, and the resulting partition replaces the builder's own.
+     * The result does not depend on the thread count or timing.
+     *
+     * Only available with deferred validation, since eager validation checks
+     * each merge against the graph built so far.
+     *
+     * @param links The pairs of field indices to link.
+     * @param trust The trust level to assign to every link (for diagnostics).
+     * @param num_threads Number of worker threads. 0 means hardware concurrency.
+     * @throw GraphCoreError with `InvalidState` if eager validation is enabled,
+     *        `InvalidFieldIndex` if an index is invalid, or `TypeMismatch` if
+     *        two linked fields have different type information.
+     */
+    void link_fields_parallel(const std::vector<std::pair<FieldIdx, FieldIdx>>& links,
+                              TrustLevel trust,
+                              size_t num_threads = 0);
+
     /**
      * @brief Get diagnostics information about the graph.
      *
@@ -137,13 +196,104 @@ public:
      */
     std::shared_ptr<GraphCoreDiagnostics> get_diagnostics(bool treat_as_sealed = false) const;
 
+    /**
+     * @brief Get diagnostics information into a caller-owned object.
+     *
+     * @details
+     * Same as `get_diagnostics()`, but replaces the contents of `out` instead of
+     * allocating a new object. The capacity of its item vectors is kept.
+     *
+     * @param out The diagnostics object to refill.
+     * @param treat_as_sealed See `get_diagnostics()`.
+     */
+    void get_diagnostics_into(GraphCoreDiagnostics& out, bool treat_as_sealed = false) const;
+
     /**
      * @brief Export the graph structure.
+     * @param options Options controlling the export, see `ExportOptions`.
      * @return Shared pointer to the exported graph containing computed relationships.
      * @throw GraphCoreError with `InvalidState` if the graph has unresolved errors
      *        that prevent export.
      */
-    std::shared_ptr<ExportedGraph> export_graph() const;
+    std::shared_ptr<ExportedGraph> export_graph(const ExportOptions& options = {}) const;
+
+    /**
+     * @brief Export the graph structure into a caller-owned object.
+     *
+     * @details
+     * Same as `export_graph()`, but replaces the contents of `out` instead of
+     * allocating a new object. The capacity of every vector in `out` is kept,
+     * including the `field_usages` of existing `data_infos` entries, so that
+     * repeated exports of similar graphs into the same object reuse storage.
+     *
+     * @param out The exported graph to refill.
+     * @param options Options controlling the export, see `ExportOptions`.
+     * @throw GraphCoreError with `InvalidState` if the graph has unresolved errors
+     *        that prevent export. The contents of `out` are then unspecified.
+     */
+    void export_graph_into(ExportedGraph& out, const ExportOptions& options = {}) const;
+
+    /**
+     * @brief Export the graph structure, consuming the builder.
+     *
+     * @details
+     * Produces the same result as `export_graph()`, for the common case where
+     * the builder is discarded right after the export. The savings are limited
+     * to the explicit step links, which are moved into `explicit_step_links`
+     * instead of copied: the export saves one copy of that vector over
+     * `export_graph()`. Everything else is built as by `export_graph()`, since
+     * the other builder state has no counterpart in `ExportedGraph`; in
+     * particular `combined_step_links` is still its own copy of the explicit
+     * and implicit links.
+     *
+     * Usage: `auto exported = std::move(graph).into_exported();`
+     *
+     * @param options Options controlling the export, see `ExportOptions`.
+     * @return Shared pointer to the exported graph.
+     * @throw GraphCoreError with `InvalidState` if the graph has unresolved errors
+     *        that prevent export. The builder is then left unchanged, and can be
+     *        inspected or fixed.
+     * @post On success, the builder is empty, as after `clear()`, and can be reused.
+     */
+    std::shared_ptr<ExportedGraph> into_exported(const ExportOptions& options = {}) &&;
+
+    /**
+     * @brief Export the maximal valid subgraph, leaving out the parts affected by errors.
+     *
+     * @details
+     * Diagnostics are computed as if the graph were sealed. Every step involved
+     * in an error (directly, or by owning an involved field) is excluded, as is
+     * every step that is downstream of an excluded step through explicit or
+     * implicit links. This covers steps downstream of a cycle or of a data object
+     * without a Create. A field is excluded if and only if its owning step is.
+     *
+     * The remaining steps and fields are exported as if they were the whole graph:
+     * - Step and field indices are the original indices in this `GraphCore`.
+     * - `field_data_pairs` lists only retained fields.
+     * - Data objects are numbered densely over the classes that retain a field.
+     * - Only links between retained steps are kept.
+     *
+     * @param options Options controlling the export, see `ExportOptions`.
+     * @return Shared pointer to the partial export. Unlike `export_graph()`, this
+     *         never throws for an invalid graph; in the worst case all steps are excluded.
+     */
+    std::shared_ptr<PartialExportedGraph> export_valid_subgraph(
+        const ExportOptions& options = {}) const;
+
+    /**
+     * @brief Export the graph structure, storing each step link once.
+     *
+     * @details
+     * Same as `export_graph()` with default options, except that the three
+     * link lists are views into one buffer; see `CompactExportedGraph`. This
+     * roughly halves the memory taken by links. Link reduction is not offered,
+     * since the reduced links are not a segment of that buffer.
+     *
+     * @return Shared pointer to the compact export.
+     * @throw GraphCoreError with `InvalidState` if the graph has unresolved errors
+     *        that prevent export.
+     */
+    std::shared_ptr<CompactExportedGraph> export_compact_graph() const;
 
 private:
     // -------------------------------------------------------------------------
@@ -161,6 +311,8 @@ private:
 
     /// For each step, the list of field indices owned by that step.
     /// Indexed by step index.
+    /// Like the other per-step lists, it may be longer than m_step_count:
+    /// entries past it are empty lists kept by clear() for their capacity.
     std::vector<std::vector<FieldIdx>> m_step_fields;
 
     /// Forward adjacency list for step dependencies (explicit + implicit).
@@ -168,6 +320,16 @@ private:
     /// Used for eager cycle detection via reachability queries.
     std::vector<std::vector<StepIdx>> m_step_successors;
 
+    /// Origin of an entry in m_step_successors, for cycle path reporting.
+    struct StepEdgeOrigin
+    {
+        bool is_explicit;   ///< True if added by link_steps(), false if implicit.
+        size_t link_index;  ///< Index into m_explicit_step_links or m_field_links.
+    };
+
+    /// Origins of the successor edges, parallel to m_step_successors.
+    std::vector<std::vector<StepEdgeOrigin>> m_step_successor_origins;
+
     // -------------------------------------------------------------------------
     // Field tracking
     // -------------------------------------------------------------------------
@@ -198,9 +360,32 @@ private:
     // Field links (equivalence classes)
     // -------------------------------------------------------------------------
 
+    /// Per-class counts of Create and Destroy fields, kept by the union-find
+    /// so that eager validation can check them without visiting members.
+    struct FieldUsageCounts
+    {
+        size_t creates = 0;
+        size_t destroys = 0;
+
+        static FieldUsageCounts of(Usage usage) noexcept
+        {
+            return FieldUsageCounts{usage == Usage::Create ? size_t{1} : size_t{0},
+                                    usage == Usage::Destroy ? size_t{1} : size_t{0}};
+        }
+
+        void merge(const FieldUsageCounts& other) noexcept
+        {
+            creates += other.creates;
+            destroys += other.destroys;
+        }
+    };
+
+    using FieldUnionFind = IterableUnionFind<FieldIdx, FieldUsageCounts>;
+
     /// Union-find structure for field equivalence classes.
-    /// Provides O(α(n)) find/unite and O(class_size) iteration.
-    IterableUnionFind<FieldIdx> m_field_uf;
+    /// Provides O(α(n)) find/unite, O(class_size) iteration, and the usage
+    /// counts of each class.
+    FieldUnionFind m_field_uf;
 
     /// Field link edges: (field_one_idx, field_two_idx).
     std::vector<std::pair<FieldIdx, FieldIdx>> m_field_links;
@@ -208,13 +393,57 @@ private:
     /// Trust levels for field links, parallel to m_field_links.
     std::vector<TrustLevel> m_field_link_trust;
 
+    // -------------------------------------------------------------------------
+    // Structural hash (see structural_hash())
+    // -------------------------------------------------------------------------
+
+    /// Sum over fields of the hash of (field, owner step, type, usage).
+    uint64_t m_field_hash_sum = 0;
+
+    /// Sum over field classes of the mixed member hash sum of the class.
+    uint64_t m_field_partition_hash_sum = 0;
+
+    /// Sum over explicit step links of the hash of (before, after).
+    uint64_t m_explicit_link_hash_sum = 0;
+
+    /// For each class root, the sum of the member field hashes of its class.
+    /// Indexed by field index; entries of non-root fields are stale.
+    std::vector<uint64_t> m_field_class_hash;
+
     // -------------------------------------------------------------------------
     // Cycle detection helpers
     // -------------------------------------------------------------------------
 
+    /// Reusable workspace for is_reachable_from(), sized to m_step_count.
+    /// A step is visited in the current search iff m_reach_mark[s] == m_reach_epoch.
+    std::vector<uint32_t> m_reach_mark;
+    uint32_t m_reach_epoch = 0;
+
+    /// For each visited step, the step it was first reached from, and the
+    /// position of the edge within m_step_successors[parent].
+    std::vector<StepIdx> m_reach_parent;
+    std::vector<size_t> m_reach_parent_edge;
+
+    /// DFS stack, kept to reuse its capacity.
+    std::vector<StepIdx> m_reach_stack;
+
     /// Check if target is reachable from 'from' in the step successor graph.
-    /// Used for eager cycle detection.
-    bool is_reachable_from(StepIdx from, StepIdx target) const;
+    /// Used for eager cycle detection. Records parent pointers in the workspace,
+    /// so that a successful search can be followed by get_reach_path().
+    bool is_reachable_from(StepIdx from, StepIdx target);
+
+    /// Reconstruct the path found by the last successful is_reachable_from(from, target).
+    void get_reach_path(StepIdx from, StepIdx target,
+                        std::vector<StepIdx>& out_steps,
+                        std::vector<CycleLink>& out_links) const;
+
+    /// Throw CycleDetected for a rejected edge (before, after), with the path
+    /// found by the last successful is_reachable_from(after, before).
+    [[noreturn]] void throw_cycle_detected(StepIdx before, StepIdx after,
+                                           const std::string& what) const;
+
+    /// Record a new edge in m_step_successors and m_step_successor_origins.
+    void add_step_successor(StepIdx before, StepIdx after, StepEdgeOrigin origin);
 
     /// Determine the implicit edge induced by two field usages.
     /// @param step_a Step index of first field
@@ -227,13 +456,73 @@ private:
     static std::optional<std::pair<StepIdx, StepIdx>> get_implicit_edge(
         StepIdx step_a, Usage usage_a, StepIdx step_b, Usage usage_b);
 
+    // -------------------------------------------------------------------------
+    // Field equivalence class bucketing
+    // -------------------------------------------------------------------------
+
+    /// Field equivalence classes in a compressed sparse row (CSR) layout.
+    /// Classes are numbered densely in order of their lowest field index, and
+    /// members within a class appear in increasing field index order.
+    struct FieldClassBuckets
+    {
+        /// Dense class index for each field. Indexed by field index.
+        std::vector<DataIdx> field_class;
+
+        /// Members of class c are class_members[class_offsets[c] .. class_offsets[c + 1]).
+        /// Has class_count() + 1 entries.
+        std::vector<size_t> class_offsets;
+
+        /// Field indices grouped by class.
+        std::vector<FieldIdx> class_members;
+
+        size_t class_count() const noexcept
+        {
+            return class_offsets.empty() ? 0 : class_offsets.size() - 1;
+        }
+    };
+
+    /// Bucket all fields by equivalence class, using the union-find's dense
+    /// relabeling and CSR export. Linear passes; no hashing.
+    void build_field_classes(FieldClassBuckets& out) const;
+
+    /// Append the implicit step links induced by field usages within each class.
+    /// Fields marked in excluded_fields (if given) induce no links.
+    void append_implicit_step_links(const FieldClassBuckets& classes,
+                                    const std::vector<bool>* excluded_fields,
+                                    std::vector<StepLinkPair>& out) const;
+
+    /// Populate the field-to-data mapping and data infos from precomputed field
+    /// classes. Fields marked in excluded_fields (if given) are left out.
+    void fill_data_objects(const FieldClassBuckets& classes,
+                           const std::vector<bool>* excluded_fields,
+                           std::vector<FieldDataPair>& out_field_data_pairs,
+                           std::vector<DataInfo>& out_data_infos) const;
+
+    /// Populate an exported graph from precomputed field classes.
+    /// Steps and fields marked in the (optional) exclusion bitsets are left out.
+    /// out.topological_order is taken as given if already filled, and
+    /// out.explicit_step_links if explicit_step_links_given is true.
+    void fill_exported_graph(const FieldClassBuckets& classes,
+                             const std::vector<bool>* excluded_steps,
+                             const std::vector<bool>* excluded_fields,
+                             bool explicit_step_links_given,
+                             const ExportOptions& options,
+                             ExportedGraph& out) const;
+
+    /// Run all diagnostic phases over precomputed field classes.
+    /// If out_topological_order is given, it receives the order found by the
+    /// cycle check, or is left empty if there is a cycle.
+    void collect_diagnostics(const FieldClassBuckets& classes,
+                             bool treat_as_sealed,
+                             GraphCoreDiagnostics& out,
+                             std::vector<StepIdx>* out_topological_order = nullptr) const;
+
     // -------------------------------------------------------------------------
     // Diagnostic helpers
     // -------------------------------------------------------------------------
 
     /// Add blamed field links to diagnostic item, ordered by trust level.
-    void add_field_link_blame(IterableUnionFind<FieldIdx>& field_uf,
-                              DiagnosticItem& item,
+    void add_field_link_blame(DiagnosticItem& item,
                               const std::vector<FieldIdx>& involved_fields) const;
 
     /// Add blamed step links to diagnostic item, ordered by trust level.
@@ -3,6 +3,7 @@
  */
 #pragma once
 #include "crddagt/common/common.hpp"
+#include "crddagt/common/graph_core_enums.hpp"
 
 namespace crddagt
 {
@@ -29,6 +30,34 @@ enum class GraphCoreErrorCode
     InvariantViolation
 };
 
+/**
+ * @brief One step-to-step edge on a cycle path reported by `GraphCoreError`.
+ *
+ * @details
+ * Each edge is either an explicit link from `GraphCore::link_steps()`, or an
+ * implicit link induced by two fields of the same data object. For implicit
+ * links, `link_index` identifies the `link_fields()` call that introduced the
+ * edge, and `before_field` / `after_field` are fields of the same data object
+ * owned by `before` and `after` whose usages induce the edge.
+ */
+struct CycleLink
+{
+    StepIdx before;
+    StepIdx after;
+
+    /// True if the edge is an explicit step link.
+    bool is_explicit;
+
+    /// Index into the explicit step links if `is_explicit`, otherwise into the field links.
+    size_t link_index;
+
+    /// Field owned by `before` that induces the edge. Unused for explicit links.
+    FieldIdx before_field = std::numeric_limits<FieldIdx>::max();
+
+    /// Field owned by `after` that induces the edge. Unused for explicit links.
+    FieldIdx after_field = std::numeric_limits<FieldIdx>::max();
+};
+
 /**
  * @brief Exception class for GraphCore errors.
  *
@@ -55,6 +84,24 @@ public:
     {
     }
 
+    /**
+     * @brief Construct a GraphCoreError carrying the path that closes a cycle.
+     * @param code The error code, normally `CycleDetected`.
+     * @param message A descriptive message explaining the error.
+     * @param cycle_steps The existing path of steps, see `cycle_steps()`.
+     * @param cycle_links The existing links along that path, see `cycle_links()`.
+     */
+    GraphCoreError(GraphCoreErrorCode code,
+                   std::string message,
+                   std::vector<StepIdx> cycle_steps,
+                   std::vector<CycleLink> cycle_links)
+        : m_code(code)
+        , m_message(std::move(message))
+        , m_cycle_steps(std::move(cycle_steps))
+        , m_cycle_links(std::move(cycle_links))
+    {
+    }
+
     /**
      * @brief Get the error code.
      * @return The error code for this exception.
@@ -73,9 +120,30 @@ public:
         return m_message.c_str();
     }
 
+    /**
+     * @brief Get the existing step path that the rejected link would close into a cycle.
+     * @return Steps from the rejected link's `after` step to its `before` step,
+     *         inclusive. Empty unless the error was raised by eager cycle detection.
+     */
+    const std::vector<StepIdx>& cycle_steps() const noexcept
+    {
+        return m_cycle_steps;
+    }
+
+    /**
+     * @brief Get the existing links along `cycle_steps()`.
+     * @return One link per consecutive pair of `cycle_steps()`, in path order.
+     */
+    const std::vector<CycleLink>& cycle_links() const noexcept
+    {
+        return m_cycle_links;
+    }
+
 private:
     GraphCoreErrorCode m_code;
     std::string m_message;
+    std::vector<StepIdx> m_cycle_steps;
+    std::vector<CycleLink> m_cycle_links;
 };
 
 } // namespace crddagt
@@ -0,0 +1,55 @@
+/**
+ * @file graph_core_pool.cpp
+ */
+#include "crddagt/common/graph_core_pool.hpp"
+
+namespace crddagt
+{
+
+GraphCorePool::GraphCorePool(size_t max_idle)
+    : m_max_idle(max_idle)
+{
+}
+
+std::unique_ptr<GraphCore> GraphCorePool::acquire(bool eager_validation)
+{
+    std::unique_ptr<GraphCore> graph;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_idle.empty())
+        {
+            graph = std::move(m_idle.back());
+            m_idle.pop_back();
+        }
+    }
+    if (!graph)
+    {
+        return std::make_unique<GraphCore>(eager_validation);
+    }
+    // Already cleared by release(); only the validation mode may differ
+    graph->reset(eager_validation);
+    return graph;
+}
+
+void GraphCorePool::release(std::unique_ptr<GraphCore> graph)
+{
+    if (!graph)
+    {
+        return;
+    }
+    // Clear outside the lock; it is linear in the size of the graph
+    graph->clear();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_idle.size() < m_max_idle)
+    {
+        m_idle.push_back(std::move(graph));
+    }
+}
+
+size_t GraphCorePool::idle_count() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_idle.size();
+}
+
+} // namespace crddagt
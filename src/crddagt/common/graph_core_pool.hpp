@@ -0,0 +1,62 @@
+/**
+ * @file graph_core_pool.hpp
+ * @brief A pool of recycled GraphCore instances.
+ */
+#pragma once
+#include "crddagt/common/common.hpp"
+#include "crddagt/common/graph_core.hpp"
+
+#include <mutex>
+
+namespace crddagt
+{
+
+/**
+ * @brief Hands out empty GraphCore instances, reusing released ones.
+ *
+ * @details
+ * A released graph is cleared with `GraphCore::clear()`, which keeps the
+ * capacity of its buffers, and kept for the next `acquire()`. Workers that
+ * repeatedly build graphs of similar size therefore stop allocating once the
+ * pool is warm. A recycled graph keeps the capacity of the largest graph it
+ * has held; `max_idle` bounds how many such graphs the pool retains.
+ *
+ * @par Thread safety
+ * - `acquire()` and `release()` may be called concurrently from any thread.
+ * - A graph handed out is owned by the caller and is not synchronized.
+ */
+class GraphCorePool
+{
+public:
+    /**
+     * @param max_idle The most released graphs kept for reuse. Graphs released
+     *        beyond this are destroyed.
+     */
+    explicit GraphCorePool(size_t max_idle = 16);
+
+    GraphCorePool(const GraphCorePool&) = delete;
+    GraphCorePool& operator=(const GraphCorePool&) = delete;
+
+    /**
+     * @brief Get an empty graph, recycled if one is available.
+     * @param eager_validation See `GraphCore::GraphCore()`.
+     * @return The graph. Never null.
+     */
+    std::unique_ptr<GraphCore> acquire(bool eager_validation = true);
+
+    /**
+     * @brief Return a graph to the pool.
+     * @param graph The graph, in any state. Null is ignored.
+     */
+    void release(std::unique_ptr<GraphCore> graph);
+
+    /// The number of released graphs currently kept for reuse.
+    size_t idle_count() const;
+
+private:
+    const size_t m_max_idle;
+    mutable std::mutex m_mutex;
+    std::vector<std::unique_ptr<GraphCore>> m_idle;
+};
+
+} // namespace crddagt
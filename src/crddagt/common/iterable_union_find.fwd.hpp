@@ -3,15 +3,36 @@
  * @brief Forward declaration of the IterableUnionFind class template.
  */
 #pragma once
+#include <cstddef>
 
 namespace crddagt {
 
+/**
+ * @brief The default Aggregate of IterableUnionFind: no per-class value.
+ *
+ * Stores nothing; IterableUnionFind keeps no aggregate array for it.
+ */
+struct NoClassAggregate {
+    void merge(const NoClassAggregate&) noexcept {}
+};
+
+/// Storage policies of IterableUnionFind. Refer to iterable_union_find.hpp.
+struct ContiguousStorage;
+struct CowPagedStorage;
+
 /**
  * @brief Forward declaration of IterableUnionFind.
  *
  * @tparam Idx The index type. Refer to iterable_union_find.hpp.
+ * @tparam Aggregate The per-class value type. Refer to iterable_union_find.hpp.
+ * @tparam Storage The storage policy. Refer to iterable_union_find.hpp.
  */
-template <typename Idx>
+template <typename Idx = std::size_t, typename Aggregate = NoClassAggregate,
+          typename Storage = ContiguousStorage>
 class IterableUnionFind;
 
+/// An IterableUnionFind whose copies share storage, with a cheap snapshot().
+template <typename Idx = std::size_t, typename Aggregate = NoClassAggregate>
+using SnapshotUnionFind = IterableUnionFind<Idx, Aggregate, CowPagedStorage>;
+
 } // namespace crddagt
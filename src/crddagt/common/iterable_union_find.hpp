@@ -6,26 +6,96 @@
 #pragma once
 #include "crddagt/common/common.hpp"
 #include "crddagt/common/iterable_union_find.fwd.hpp"
+#include "crddagt/common/cow_paged_array.hpp"
 
 namespace crddagt {
 
+/**
+ * @brief Storage policy of IterableUnionFind: each per-element array is a std::vector.
+ *
+ * The default. Copies of the structure are deep copies.
+ */
+struct ContiguousStorage {
+    template <typename T>
+    using Array = std::vector<T>;
+
+    template <typename T>
+    static T& mut(std::vector<T>& array, size_t i)
+    {
+        return array[i];
+    }
+};
+
+/**
+ * @brief Storage policy of IterableUnionFind: each per-element array is a CowPagedArray.
+ *
+ * Copies of the structure, including snapshot(), share pages until written.
+ * Every write pays a page lookup and a sharing check, so use this policy only
+ * where snapshots are needed.
+ */
+struct CowPagedStorage {
+    template <typename T>
+    using Array = CowPagedArray<T>;
+
+    template <typename T>
+    static T& mut(CowPagedArray<T>& array, size_t i)
+    {
+        return array.mut(i);
+    }
+};
+
 /**
  * @brief A union-find data structure with O(class_size) iteration support.
  *
  * This class implements a disjoint-set (union-find) data structure with:
  * - **Union-by-rank**: Keeps trees balanced for O(alpha(n)) amortized find operations
  * - **Path compression**: Flattens trees during find for efficiency (two-pass iterative)
+ * - **Explicit flattening**: flatten() makes const root queries O(1) until the next merge
+ * - **Rollback**: checkpoint() / rollback() undo unions and new elements exactly
+ * - **Class aggregates**: An optional per-class value, combined by unite()
+ * - **Bulk construction**: init_from_edges() builds a partition on several threads
+ * - **Snapshots**: With CowPagedStorage, snapshot() shares storage with the
+ *   original until either is modified
  * - **Exact size tracking**: Maintains class sizes with totality invariant
  * - **Circular linked list**: Enables O(class_size) enumeration of class members
+ * - **Root list**: Optionally keeps the current roots, so classes are listed
+ *   in time proportional to their number; see enable_root_list()
+ *
+ * @par Memory Layout
+ * Element data is stored as separate arrays rather than an array of nodes, so
+ * that find() touches only what it needs:
+ * - parent: `Idx` per element, the only array read by find() and class_root()
+ * - rank: one byte per element, read only by unite()
+ * - size, next: `Idx` per element, cold; read by unite(), class_size() and
+ *   member iteration
+ * - root position: `Idx` per element, cold, only after enable_root_list();
+ *   the slot of a root in the list of roots, which has one `Idx` per class
+ * .
+ * With `Idx = size_t`, a 64-byte cache line holds 8 parent entries instead of
+ * the 2 nodes of a combined 32-byte layout.
+ *
+ * With the default ContiguousStorage, each array is a std::vector. With
+ * CowPagedStorage, each is a CowPagedArray of 4096-element pages: copies of the
+ * structure, including snapshot(), share the pages, and a page is copied the
+ * first time either side writes to it, so a union after a snapshot copies at
+ * most a few pages.
  *
  * @tparam Idx The index type, defaults to size_t. Must be unsigned.
  *         Supports uint16_t, uint32_t, or size_t.
  *         uint64_t is supported if exclusively targeting 64-bit platforms.
+ * @tparam Aggregate A per-class value, such as counts or a bitmask, defaults to
+ *         NoClassAggregate (none). It must be default constructible and copyable,
+ *         and have `void merge(const Aggregate& other)`, which folds the value
+ *         of another class into this one. Which root survives a union is an
+ *         implementation detail, so merge should be commutative and associative.
+ * @tparam Storage ContiguousStorage (the default) or CowPagedStorage, which
+ *         enables snapshot(). SnapshotUnionFind names the latter.
  *
  * @par Thread Safety
  * Externally synchronized. No internal synchronization. Caller must ensure:
  * - No concurrent modifications
  * - Concurrent const operations are safe only if no non-const operations occur
+ * - Distinct copies may be used from different threads, with either storage policy
  *
  * @par Index Validation
  * All operations validate indices and throw std::runtime_error with a descriptive
@@ -35,6 +105,14 @@ namespace crddagt {
  * The maximum number of elements is limited by std::numeric_limits<Idx>::max().
  * make_set() throws std::overflow_error if this limit would be exceeded.
  *
+ * @par Checkpoints
+ * While a checkpoint is open, unite() logs what it changes and find() does not
+ * compress paths, so rollback() can restore the parent, rank, size and `next`
+ * arrays exactly, in time proportional to the operations undone. The class
+ * count is restored as well, and so is the set of roots in an enabled root
+ * list, though not their order.
+ * Checkpoints nest and must be closed in reverse order, by rollback() or commit().
+ *
  * @par Include Usage
  * - Include `iterable_union_find.hpp` for class definition (e.g., in headers with member variables)
  * - Include `iterable_union_find.inline.hpp` in source files that call member functions
@@ -43,7 +121,7 @@ namespace crddagt {
  * `alpha(n)` is the inverse Ackermann function, which grows extremely slowly, and is
  * effectively a constant capped at 5 for all practical `n`.
  */
-template <typename Idx = size_t>
+template <typename Idx, typename Aggregate, typename Storage>
 class IterableUnionFind {
 public:
     static_assert(std::is_unsigned_v<Idx>,
@@ -52,10 +130,14 @@ public:
     static_assert(sizeof(Idx) <= sizeof(size_t),
                   "IterableUnionFind: Idx size must not exceed size_t size");
 
+    /// True unless Aggregate is NoClassAggregate.
+    static constexpr bool has_aggregate = !std::is_same_v<Aggregate, NoClassAggregate>;
+
     /**
-     * @brief Per-element node storing union-find metadata.
+     * @brief Per-element union-find metadata, as reported by export_nodes().
      *
-     * All fields use the same Idx type for uniformity and cache efficiency.
+     * This is an export format only; the data is stored as separate arrays
+     * (see Memory Layout above).
      */
     struct Node {
         Idx parent;  ///< Parent pointer (self if root)
@@ -64,6 +146,16 @@ public:
         Idx next;    ///< Next element in circular linked list
     };
 
+    /**
+     * @brief A point to return to, as returned by checkpoint().
+     */
+    struct Checkpoint {
+        size_t serial;         ///< Distinguishes this checkpoint from all others of this structure
+        size_t log_size;       ///< Undo log entries before this checkpoint
+        size_t element_count;  ///< Elements before this checkpoint
+        bool is_flat;          ///< is_flat() before this checkpoint
+    };
+
     // =========================================================================
     // Construction
     // =========================================================================
@@ -73,6 +165,21 @@ public:
      */
     IterableUnionFind() = default;
 
+    /**
+     * @brief Returns a copy of the current partition that shares storage with this one.
+     *
+     * Costs O(element_count() / 4096) pointer copies, independent of the
+     * element and aggregate types. Later changes to either structure copy only
+     * the pages they write, and are not seen by the other. The snapshot has
+     * no open checkpoints, even if this structure has.
+     *
+     * The snapshot may be read on another thread while this structure is modified.
+     * Only available with CowPagedStorage.
+     *
+     * @return The snapshot.
+     */
+    [[nodiscard]] IterableUnionFind snapshot() const;
+
     // =========================================================================
     // Element Management
     // =========================================================================
@@ -97,6 +204,39 @@ public:
     template <typename SizeType>
     void init_sets(SizeType count);
 
+    /**
+     * @brief Initializes the structure with the connected components of an edge list.
+     *
+     * The result has the same classes as init_sets(count) followed by
+     * unite(a, b) for each edge, built by parallel hooking instead: each edge
+     * links the larger of its two current roots below the smaller one with a
+     * compare-and-swap, then every element is pointed at its root.
+     *
+     * The result is deterministic: the root of each class is its smallest
+     * element, members are listed in increasing order starting from the root,
+     * and is_flat() is true. Aggregates are default-constructed and merged.
+     *
+     * @param count The number of elements.
+     * @param edges Pairs of elements to place in the same class.
+     * @param num_threads Number of worker threads. 0 means hardware concurrency.
+     * @throws std::logic_error if called on a non-empty instance.
+     * @throws std::overflow_error if count exceeds the maximum of Idx.
+     * @throws std::runtime_error if an edge endpoint is not less than count.
+     *         Nothing is changed in that case.
+     */
+    void init_from_edges(size_t count,
+                         const std::vector<std::pair<Idx, Idx>>& edges,
+                         size_t num_threads = 0);
+
+    /**
+     * @brief Removes all elements, keeping the allocated capacity.
+     *
+     * Afterwards the instance is empty, as if default constructed, and
+     * make_set() or init_sets() can be used to start over without reallocating.
+     * Open checkpoints are discarded.
+     */
+    void clear() noexcept;
+
     /**
      * @brief Creates a new singleton set and returns its index.
      *
@@ -107,6 +247,16 @@ public:
      */
     Idx make_set();
 
+    /**
+     * @brief Creates a new singleton set with the given aggregate value.
+     *
+     * @param value The aggregate of the new class. init_sets() and make_set()
+     *        without arguments use a default-constructed Aggregate.
+     * @return The index of the newly created element
+     * @throw std::overflow_error if adding another element would overflow Idx
+     */
+    Idx make_set(const Aggregate& value);
+
     /**
      * @brief Returns the total number of elements created.
      *
@@ -131,6 +281,7 @@ public:
      *
      * @note This method is non-const because path compression modifies state.
      *       Use class_root() for const access (without compression).
+     *       While a checkpoint is open, paths are not compressed.
      */
     Idx find(Idx x);
 
@@ -138,7 +289,8 @@ public:
      * @brief Merges the sets containing a and b.
      *
      * Uses union-by-rank to keep trees balanced. The circular linked lists
-     * are spliced at the roots for deterministic behavior.
+     * are spliced at the roots for deterministic behavior. The aggregate of
+     * the absorbed class is merged into that of the surviving root.
      *
      * @param a An element in the first set
      * @param b An element in the second set
@@ -147,6 +299,25 @@ public:
      */
     bool unite(Idx a, Idx b);
 
+    /**
+     * @brief Points every element directly at the root of its class.
+     *
+     * One linear pass; each element's parent is rewritten at most once.
+     * Afterwards is_flat() is true, so class_root(), same_class() and
+     * class_size() answer in O(1) without modifying the structure.
+     *
+     * @throw std::logic_error if a checkpoint is open.
+     */
+    void flatten();
+
+    /**
+     * @brief Returns true if every element's parent is the root of its class.
+     *
+     * Set by flatten() and kept by make_set(), and by unite() when the class
+     * it absorbs is a singleton. Any other merge clears it.
+     */
+    [[nodiscard]] bool is_flat() const noexcept;
+
     // =========================================================================
     // Queries
     // =========================================================================
@@ -173,11 +344,26 @@ public:
      */
     [[nodiscard]] Idx class_rank(Idx x) const;
 
+    /**
+     * @brief Returns the aggregate value of the equivalence class containing x.
+     *
+     * Costs one class_root() call: O(log n) by union-by-rank, O(1) if is_flat().
+     * Only available when an Aggregate type is given.
+     *
+     * @param x An element in the class
+     * @return The merged value of all elements of the class. The reference is
+     *         valid until the next non-const call.
+     * @throw std::runtime_error if x is out of range
+     */
+    [[nodiscard]] const Aggregate& class_aggregate(Idx x) const;
+
     /**
      * @brief Finds the root of the set containing x, without path compression.
      *
-     * This is a const method that does not modify the structure.
-     * Use find() for better amortized performance when const is not required.
+     * This is a const method that does not modify the structure. It walks the
+     * parent chain, unless is_flat() is true, in which case it is O(1).
+     * Use find() or flatten() for better amortized performance when const is
+     * not required.
      *
      * @param x The element to find the root of
      * @return The root of the set containing x
@@ -185,6 +371,25 @@ public:
      */
     [[nodiscard]] Idx class_root(Idx x) const;
 
+    /**
+     * @brief Finds the roots of many elements, without path compression.
+     *
+     * Gives the same result as class_root() for each element, but keeps up to
+     * 16 parent walks in flight at once and prefetches the parent entry each
+     * walk needs next, so the cache misses of independent walks overlap
+     * instead of following one another. If is_flat(), each root is a single
+     * prefetched load.
+     *
+     * All indices are validated before any output is written.
+     *
+     * @param elements Pointer to count elements.
+     * @param out_roots Pointer to count outputs; out_roots[i] is set to the
+     *        root of elements[i]. May be the same as elements.
+     * @param count The number of elements.
+     * @throw std::runtime_error if an element is out of range
+     */
+    void find_batch(const Idx* elements, Idx* out_roots, size_t count) const;
+
     /**
      * @brief Populates a vector with all members of the equivalence class containing x.
      *
@@ -214,8 +419,7 @@ public:
     /**
      * @brief Returns the number of distinct equivalence classes.
      *
-     * Counts elements that are roots (parent points to self).
-     * This is an O(n) operation.
+     * O(1): the count is kept up to date by make_set(), unite() and rollback().
      *
      * @return The number of equivalence classes
      */
@@ -226,6 +430,8 @@ public:
      *
      * Each root uniquely identifies one equivalence class. The output vector
      * is cleared before populating. Roots are returned in index order.
+     * Costs O(element_count()), or O(k log k) for k classes once
+     * enable_root_list() has been called.
      *
      * @param out_roots Output vector to populate with class roots
      *
@@ -235,6 +441,35 @@ public:
      */
     void get_class_representatives(std::vector<Idx>& out_roots) const;
 
+    /**
+     * @brief Starts keeping a list of the current roots.
+     *
+     * Costs O(element_count()) once; afterwards make_set(), unite() and
+     * rollback() keep the list up to date in O(1) each, at the cost of one
+     * more `Idx` per element and per class, and get_class_representatives()
+     * no longer scans every element. Worth it when classes are listed often
+     * and are far fewer than elements. Does nothing if already enabled;
+     * clear() disables it.
+     */
+    void enable_root_list();
+
+    /**
+     * @brief Returns true if enable_root_list() is in effect.
+     */
+    [[nodiscard]] bool has_root_list() const noexcept;
+
+    /**
+     * @brief Populates a vector with the root of every element.
+     *
+     * Equivalent to calling class_root() for each element, but O(n) in total
+     * without modifying the structure: each parent chain is walked once, and
+     * the roots found along it are reused by later elements.
+     *
+     * @param out_roots Output vector, replaced with element_count() entries;
+     *        out_roots[x] is the root of x.
+     */
+    void get_roots(std::vector<Idx>& out_roots) const;
+
     /**
      * @brief Populates a vector with all equivalence classes and their members.
      *
@@ -247,6 +482,82 @@ public:
      */
     void get_classes(std::vector<std::vector<Idx>>& out_classes) const;
 
+    /**
+     * @brief Numbers the equivalence classes densely, in order of first appearance.
+     *
+     * The class of element 0 is 0, and each class is numbered after all classes
+     * that have a smaller element. O(n), without hashing or per-class allocation.
+     *
+     * @param element_to_class Output vector, replaced with element_count()
+     *        entries; element_to_class[x] is the dense class index of x.
+     * @return The number of classes.
+     */
+    Idx relabel_dense(std::vector<Idx>& element_to_class) const;
+
+    /**
+     * @brief Lists the members of all classes contiguously, in compressed sparse row form.
+     *
+     * Classes are numbered as by relabel_dense(), and members within a class
+     * appear in increasing order. Two linear passes: a count and a scatter.
+     *
+     * @param out_offsets Output vector, replaced with class count + 1 entries.
+     *        The members of class c are out_members[out_offsets[c] .. out_offsets[c + 1]).
+     * @param out_members Output vector, replaced with element_count() entries.
+     */
+    void export_classes_csr(std::vector<size_t>& out_offsets, std::vector<Idx>& out_members) const;
+
+    /**
+     * @brief Same as export_classes_csr(out_offsets, out_members), given the
+     *        result of relabel_dense().
+     *
+     * @param element_to_class The output of relabel_dense() for the current state.
+     * @throws std::invalid_argument if element_to_class does not have
+     *         element_count() entries, or if its class indices are not numbered
+     *         densely in order of first appearance. The contents of the
+     *         output vectors are then unspecified.
+     */
+    void export_classes_csr(const std::vector<Idx>& element_to_class,
+                            std::vector<size_t>& out_offsets,
+                            std::vector<Idx>& out_members) const;
+
+    // =========================================================================
+    // Checkpoints
+    // =========================================================================
+
+    /**
+     * @brief Opens a checkpoint that the structure can later be rolled back to.
+     *
+     * @return The checkpoint, to pass to rollback() or commit().
+     */
+    [[nodiscard]] Checkpoint checkpoint();
+
+    /**
+     * @brief Restores the state at checkpoint cp exactly, and closes it.
+     *
+     * Undoes every unite() and removes every element created since cp, in
+     * O(number of undone operations). Capacity is kept.
+     *
+     * @param cp The innermost open checkpoint.
+     * @throw std::logic_error if cp is not the innermost open checkpoint.
+     */
+    void rollback(const Checkpoint& cp);
+
+    /**
+     * @brief Keeps the changes since checkpoint cp, and closes it.
+     *
+     * The changes remain part of any enclosing checkpoint. Closing the
+     * outermost checkpoint discards the undo log and re-enables path compression.
+     *
+     * @param cp The innermost open checkpoint.
+     * @throw std::logic_error if cp is not the innermost open checkpoint.
+     */
+    void commit(const Checkpoint& cp);
+
+    /**
+     * @brief Returns the number of open checkpoints.
+     */
+    [[nodiscard]] size_t checkpoint_depth() const noexcept;
+
     // =========================================================================
     // Full state management
     // =========================================================================
@@ -268,8 +579,35 @@ public:
     void export_nodes(std::vector<Node>& out) const;
 
 private:
+    template <typename T>
+    using Array = typename Storage::template Array<T>;
+
+    /// Returns element i of an Array for writing; see the storage policies.
+    template <typename A>
+    static decltype(auto) mut(A& array, size_t i)
+    {
+        return Storage::mut(array, i);
+    }
+
     void init_sets_impl(Idx count);
 
+    /// One unite() made while a checkpoint was open.
+    struct UndoRecord {
+        Idx new_root;           ///< The root that remained a root
+        Idx old_root;           ///< The root linked below new_root
+        Idx old_root_size;      ///< Size of old_root's class before the merge
+        bool rank_incremented;  ///< Whether new_root's rank was incremented
+    };
+
+    /// Appends x, which must be a root, to the list of roots.
+    void add_root(Idx x);
+
+    /// Removes x from the list of roots in O(1); the order of the others may change.
+    void remove_root(Idx x);
+
+    /// Throws std::logic_error unless cp is the innermost open checkpoint.
+    void validate_checkpoint(const Checkpoint& cp, const char* caller) const;
+
     /**
      * @brief Validates that an index is within the valid range.
      *
@@ -278,7 +616,20 @@ private:
      */
     void validate_index(Idx x) const;
 
-    std::vector<Node> m_nodes;  ///< Per-element union-find metadata
+    Array<Idx> m_parent;      ///< Parent pointer (self if root); hot
+    Array<uint8_t> m_rank;    ///< Tree rank for union-by-rank (bounded by log2(n))
+    Array<Idx> m_size;        ///< Class size (valid only at root, 0 elsewhere); cold
+    Array<Idx> m_next;        ///< Next element in circular linked list; cold
+    Array<Aggregate> m_aggregate;  ///< Class aggregate (valid only at root); empty if none
+    Array<Idx> m_root_pos;    ///< Position in m_roots (valid only at root); empty unless m_has_root_list
+    Array<Idx> m_roots;       ///< Current roots, in no particular order; empty unless m_has_root_list
+    Idx m_class_count = 0;          ///< Number of roots; see num_classes()
+    bool m_has_root_list = false;   ///< m_root_pos and m_roots are maintained; see enable_root_list()
+    bool m_is_flat = true;          ///< Every parent is a root; see is_flat()
+    std::vector<UndoRecord> m_undo_log;  ///< Unions since the outermost open checkpoint
+    std::vector<Aggregate> m_aggregate_undo;  ///< new_root's aggregate before each logged union
+    std::vector<size_t> m_open_checkpoints;  ///< Serials of the open checkpoints, innermost last
+    size_t m_next_checkpoint_serial = 0;     ///< Serial of the next checkpoint; never reused
 };
 
 } // namespace crddagt
@@ -4,6 +4,10 @@
  */
 #pragma once
 #include "crddagt/common/iterable_union_find.hpp"
+#include "crddagt/common/parallel_chunks.hpp"
+
+#include <algorithm>
+#include <atomic>
 
 namespace crddagt {
 
@@ -11,22 +15,28 @@ namespace crddagt {
 // Element Management
 // =============================================================================
 
-template <typename Idx>
-void IterableUnionFind<Idx>::reserve(size_t reserve_size)
+template <typename Idx, typename Aggregate, typename Storage>
+void IterableUnionFind<Idx, Aggregate, Storage>::reserve(size_t reserve_size)
 {
     // Clamp to max allowed elements
     size_t max_elements = static_cast<size_t>(std::numeric_limits<Idx>::max());
     if (reserve_size > max_elements) {
         reserve_size = max_elements;
     }
-    m_nodes.reserve(reserve_size);
+    m_parent.reserve(reserve_size);
+    m_rank.reserve(reserve_size);
+    m_size.reserve(reserve_size);
+    m_next.reserve(reserve_size);
+    if constexpr (has_aggregate) {
+        m_aggregate.reserve(reserve_size);
+    }
 }
 
-template <typename Idx>
+template <typename Idx, typename Aggregate, typename Storage>
 template <typename SizeType>
-void IterableUnionFind<Idx>::init_sets(SizeType count)
+void IterableUnionFind<Idx, Aggregate, Storage>::init_sets(SizeType count)
 {
-    if (!m_nodes.empty()) {
+    if (!m_parent.empty()) {
         throw std::logic_error(
             "IterableUnionFind::init_sets: cannot call on non-empty instance");
     }
@@ -52,77 +62,258 @@ void IterableUnionFind<Idx>::init_sets(SizeType count)
     init_sets_impl(static_cast<Idx>(count));
 }
 
-template <typename Idx>
-void IterableUnionFind<Idx>::init_sets_impl(Idx count)
+template <typename Idx, typename Aggregate, typename Storage>
+void IterableUnionFind<Idx, Aggregate, Storage>::init_from_edges(size_t count,
+                                                        const std::vector<std::pair<Idx, Idx>>& edges,
+                                                        size_t num_threads)
 {
+    if (!m_parent.empty()) {
+        throw std::logic_error(
+            "IterableUnionFind::init_from_edges: cannot call on non-empty instance");
+    }
+    for (const auto& [a, b] : edges) {
+        if (static_cast<size_t>(std::max(a, b)) >= count) {
+            throw std::runtime_error(
+                "IterableUnionFind::init_from_edges: index " + std::to_string(std::max(a, b)) +
+                " out of range [0, " + std::to_string(count) + ")");
+        }
+    }
+    init_sets(count);
     if (count == 0) {
         return;
     }
 
-    m_nodes.reserve(static_cast<size_t>(count));
-    for (Idx i = 0; i < count; ++i) {
-        m_nodes.push_back(Node{
-            i,      // parent: self (is own root)
-            0,      // rank: initial 0
-            1,      // size: singleton has size 1
-            i       // next: self-loop (singleton circular list)
+    // Hook the larger root below the smaller one, so the smallest element of
+    // each component is never hooked and ends up as its root
+    std::unique_ptr<std::atomic<Idx>[]> label(new std::atomic<Idx>[count]);
+    for (size_t i = 0; i < count; ++i) {
+        label[i].store(static_cast<Idx>(i), std::memory_order_relaxed);
+    }
+    auto find_root = [&label](Idx x) {
+        while (true) {
+            Idx parent = label[x].load(std::memory_order_acquire);
+            Idx grandparent = label[parent].load(std::memory_order_acquire);
+            if (parent == grandparent) {
+                return parent;
+            }
+            // Path halving; a failed swap means another thread moved x up
+            label[x].compare_exchange_weak(parent, grandparent,
+                                           std::memory_order_release,
+                                           std::memory_order_relaxed);
+            x = grandparent;
+        }
+    };
+    run_in_chunks(edges.size(), num_threads,
+        [&](size_t begin, size_t end) {
+            for (size_t e = begin; e < end; ++e) {
+                Idx a = edges[e].first;
+                Idx b = edges[e].second;
+                while (true) {
+                    Idx root_a = find_root(a);
+                    Idx root_b = find_root(b);
+                    if (root_a == root_b) {
+                        break;
+                    }
+                    if (root_a < root_b) {
+                        std::swap(root_a, root_b);
+                    }
+                    Idx expected = root_a;
+                    if (label[root_a].compare_exchange_strong(expected, root_b,
+                                                              std::memory_order_acq_rel,
+                                                              std::memory_order_acquire)) {
+                        break;
+                    }
+                    a = root_a;
+                    b = root_b;
+                }
+            }
+        });
+    // Point every label at its root in parallel. m_parent is filled afterwards
+    // on this thread, since with CowPagedStorage writing it may copy a page.
+    run_in_chunks(count, num_threads,
+        [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                label[i].store(find_root(static_cast<Idx>(i)), std::memory_order_relaxed);
+            }
         });
+
+    // Parents, sizes, ranks and member lists in one increasing pass. tail[root]
+    // is the last member appended to the root's list so far; the lists are
+    // closed after.
+    std::vector<Idx> tail(count);
+    for (size_t i = 0; i < count; ++i) {
+        const Idx x = static_cast<Idx>(i);
+        const Idx root = label[i].load(std::memory_order_relaxed);
+        tail[i] = x;
+        if (root == x) {
+            continue;
+        }
+        mut(m_parent, x) = root;
+        mut(m_size, x) = 0;
+        ++mut(m_size, root);
+        mut(m_rank, root) = 1;  // every member is one step below the root
+        mut(m_next, tail[root]) = x;
+        tail[root] = x;
+        if constexpr (has_aggregate) {
+            mut(m_aggregate, root).merge(m_aggregate[x]);
+        }
+    }
+    // Close the lists and count the classes; an enabled root list is rebuilt
+    // in increasing order
+    m_class_count = 0;
+    m_roots.clear();
+    for (size_t i = 0; i < count; ++i) {
+        if (m_parent[i] == static_cast<Idx>(i)) {
+            mut(m_next, tail[i]) = static_cast<Idx>(i);
+            ++m_class_count;
+            if (m_has_root_list) {
+                add_root(static_cast<Idx>(i));
+            }
+        }
+    }
+    // m_is_flat is already true for the empty instance init_sets() started from
+}
+
+template <typename Idx, typename Aggregate, typename Storage>
+void IterableUnionFind<Idx, Aggregate, Storage>::clear() noexcept
+{
+    m_parent.clear();
+    m_rank.clear();
+    m_size.clear();
+    m_next.clear();
+    m_aggregate.clear();
+    m_class_count = 0;
+    m_has_root_list = false;
+    m_root_pos.clear();
+    m_roots.clear();
+    m_is_flat = true;
+    m_undo_log.clear();
+    m_aggregate_undo.clear();
+    m_open_checkpoints.clear();
+}
+
+template <typename Idx, typename Aggregate, typename Storage>
+void IterableUnionFind<Idx, Aggregate, Storage>::init_sets_impl(Idx count)
+{
+    if (count == 0) {
+        return;
+    }
+
+    const size_t n = static_cast<size_t>(count);
+    m_parent.resize(n);
+    m_rank.assign(n, 0);    // rank: initial 0
+    m_size.assign(n, 1);    // size: singleton has size 1
+    m_next.resize(n);
+    for (Idx i = 0; i < count; ++i) {
+        mut(m_parent, i) = i;    // parent: self (is own root)
+        mut(m_next, i) = i;      // next: self-loop (singleton circular list)
+    }
+    m_class_count = count;
+    if (m_has_root_list) {
+        // Every element is a root, listed in order
+        m_root_pos.resize(n);
+        m_roots.resize(n);
+        for (Idx i = 0; i < count; ++i) {
+            mut(m_root_pos, i) = i;
+            mut(m_roots, i) = i;
+        }
+    }
+    if constexpr (has_aggregate) {
+        m_aggregate.assign(n, Aggregate{});
     }
 }
 
-template <typename Idx>
-Idx IterableUnionFind<Idx>::make_set()
+template <typename Idx, typename Aggregate, typename Storage>
+Idx IterableUnionFind<Idx, Aggregate, Storage>::make_set()
+{
+    return make_set(Aggregate{});
+}
+
+template <typename Idx, typename Aggregate, typename Storage>
+Idx IterableUnionFind<Idx, Aggregate, Storage>::make_set(const Aggregate& value)
 {
     // Overflow check: ensure the new index fits in Idx
-    if (m_nodes.size() >= static_cast<size_t>(std::numeric_limits<Idx>::max())) {
+    if (m_parent.size() >= static_cast<size_t>(std::numeric_limits<Idx>::max())) {
         throw std::overflow_error(
             "IterableUnionFind: cannot create more than " +
             std::to_string(std::numeric_limits<Idx>::max()) + " elements");
     }
 
-    Idx x = static_cast<Idx>(m_nodes.size());
-    m_nodes.push_back(Node{
-        x,      // parent: self (is own root)
-        0,      // rank: initial 0
-        1,      // size: singleton has size 1
-        x       // next: self-loop (singleton circular list)
-    });
+    Idx x = static_cast<Idx>(m_parent.size());
+    m_parent.push_back(x);  // parent: self (is own root)
+    m_rank.push_back(0);    // rank: initial 0
+    m_size.push_back(1);    // size: singleton has size 1
+    m_next.push_back(x);    // next: self-loop (singleton circular list)
+    ++m_class_count;
+    if (m_has_root_list) {
+        m_root_pos.push_back(0);
+        add_root(x);
+    }
+    if constexpr (has_aggregate) {
+        m_aggregate.push_back(value);
+    } else {
+        (void)value;
+    }
     return x;
 }
 
-template <typename Idx>
-size_t IterableUnionFind<Idx>::element_count() const noexcept
+template <typename Idx, typename Aggregate, typename Storage>
+IterableUnionFind<Idx, Aggregate, Storage> IterableUnionFind<Idx, Aggregate, Storage>::snapshot() const
 {
-    return m_nodes.size();
+    static_assert(std::is_same_v<Storage, CowPagedStorage>,
+                  "IterableUnionFind::snapshot: requires CowPagedStorage (see SnapshotUnionFind)");
+    IterableUnionFind copy;
+    // Copying the paged arrays copies only their page tables
+    copy.m_parent = m_parent;
+    copy.m_rank = m_rank;
+    copy.m_size = m_size;
+    copy.m_next = m_next;
+    copy.m_aggregate = m_aggregate;
+    copy.m_class_count = m_class_count;
+    copy.m_has_root_list = m_has_root_list;
+    copy.m_root_pos = m_root_pos;
+    copy.m_roots = m_roots;
+    copy.m_is_flat = m_is_flat;
+    return copy;
+}
+
+template <typename Idx, typename Aggregate, typename Storage>
+size_t IterableUnionFind<Idx, Aggregate, Storage>::element_count() const noexcept
+{
+    return m_parent.size();
 }
 
 // =============================================================================
 // Core Operations
 // =============================================================================
 
-template <typename Idx>
-Idx IterableUnionFind<Idx>::find(Idx x)
+template <typename Idx, typename Aggregate, typename Storage>
+Idx IterableUnionFind<Idx, Aggregate, Storage>::find(Idx x)
 {
     validate_index(x);
 
     // Pass 1: Find root
     Idx root = x;
-    while (m_nodes[root].parent != root) {
-        root = m_nodes[root].parent;
+    while (m_parent[root] != root) {
+        root = m_parent[root];
     }
 
-    // Pass 2: Path compression - rewrite parents to point to root
-    while (m_nodes[x].parent != root) {
-        Idx next = m_nodes[x].parent;
-        m_nodes[x].parent = root;
+    // Pass 2: Path compression - rewrite parents to point to root.
+    // Skipped while a checkpoint is open, so that rollback() stays exact.
+    if (!m_open_checkpoints.empty()) {
+        return root;
+    }
+    while (m_parent[x] != root) {
+        Idx next = m_parent[x];
+        mut(m_parent, x) = root;
         x = next;
     }
 
     return root;
 }
 
-template <typename Idx>
-bool IterableUnionFind<Idx>::unite(Idx a, Idx b)
+template <typename Idx, typename Aggregate, typename Storage>
+bool IterableUnionFind<Idx, Aggregate, Storage>::unite(Idx a, Idx b)
 {
     // validate_index called by find()
     Idx root_a = find(a);
@@ -135,32 +326,57 @@ bool IterableUnionFind<Idx>::unite(Idx a, Idx b)
     // Compute combined size before modifying
     // Note: combined_size cannot overflow because total size <= element_count,
     // and element_count is bounded by Idx::max (enforced by make_set).
-    Idx combined_size = m_nodes[root_a].size + m_nodes[root_b].size;
+    Idx combined_size = m_size[root_a] + m_size[root_b];
 
     // Union by rank
     Idx new_root, old_root;
-    if (m_nodes[root_a].rank < m_nodes[root_b].rank) {
-        m_nodes[root_a].parent = root_b;
+    bool rank_incremented = false;
+    if (m_rank[root_a] < m_rank[root_b]) {
+        mut(m_parent, root_a) = root_b;
         new_root = root_b;
         old_root = root_a;
-    } else if (m_nodes[root_a].rank > m_nodes[root_b].rank) {
-        m_nodes[root_b].parent = root_a;
+    } else if (m_rank[root_a] > m_rank[root_b]) {
+        mut(m_parent, root_b) = root_a;
         new_root = root_a;
         old_root = root_b;
     } else {
-        m_nodes[root_b].parent = root_a;
-        // Rank increment is safe: rank <= log2(n) < sizeof(Idx)*8
-        ++m_nodes[root_a].rank;
+        mut(m_parent, root_b) = root_a;
+        // Rank increment is safe: rank <= log2(n) < 64 fits in uint8_t
+        ++mut(m_rank, root_a);
+        rank_incremented = true;
         new_root = root_a;
         old_root = root_b;
     }
 
+    // Attaching a singleton keeps every path of length at most 1; attaching a
+    // larger class leaves its members two steps from the new root.
+    if (m_size[old_root] != 1) {
+        m_is_flat = false;
+    }
+
+    if (!m_open_checkpoints.empty()) {
+        m_undo_log.push_back(UndoRecord{new_root, old_root, m_size[old_root], rank_incremented});
+        if constexpr (has_aggregate) {
+            m_aggregate_undo.push_back(m_aggregate[new_root]);
+        }
+    }
+
+    // Fold the absorbed class into the surviving root; the absorbed root's
+    // value is left as it was, and is no longer read
+    if constexpr (has_aggregate) {
+        mut(m_aggregate, new_root).merge(m_aggregate[old_root]);
+    }
+
     // Update sizes
-    m_nodes[new_root].size = combined_size;
-    m_nodes[old_root].size = 0;
+    mut(m_size, new_root) = combined_size;
+    mut(m_size, old_root) = 0;
+    --m_class_count;
+    if (m_has_root_list) {
+        remove_root(old_root);
+    }
 
     // Splice circular lists at the roots for deterministic behavior
-    std::swap(m_nodes[root_a].next, m_nodes[root_b].next);
+    std::swap(mut(m_next, root_a), mut(m_next, root_b));
 
     return true;
 }
@@ -169,42 +385,147 @@ bool IterableUnionFind<Idx>::unite(Idx a, Idx b)
 // Queries
 // =============================================================================
 
-template <typename Idx>
-size_t IterableUnionFind<Idx>::class_size(Idx x) const
+template <typename Idx, typename Aggregate, typename Storage>
+size_t IterableUnionFind<Idx, Aggregate, Storage>::class_size(Idx x) const
+{
+    return static_cast<size_t>(m_size[class_root(x)]);
+}
+
+template <typename Idx, typename Aggregate, typename Storage>
+Idx IterableUnionFind<Idx, Aggregate, Storage>::class_rank(Idx x) const
 {
-    return static_cast<size_t>(m_nodes[class_root(x)].size);
+    return static_cast<Idx>(m_rank[class_root(x)]);
 }
 
-template <typename Idx>
-Idx IterableUnionFind<Idx>::class_rank(Idx x) const
+template <typename Idx, typename Aggregate, typename Storage>
+void IterableUnionFind<Idx, Aggregate, Storage>::flatten()
 {
-    return m_nodes[class_root(x)].rank;
+    if (!m_open_checkpoints.empty()) {
+        throw std::logic_error(
+            "IterableUnionFind::flatten: cannot flatten while a checkpoint is open");
+    }
+    if (m_is_flat) {
+        return;
+    }
+    // Full compression from each element in turn; every node on a walked path
+    // ends up pointing at its root, so later walks through it take one step.
+    const Idx n = static_cast<Idx>(m_parent.size());
+    for (Idx i = 0; i < n; ++i) {
+        Idx root = i;
+        while (m_parent[root] != root) {
+            root = m_parent[root];
+        }
+        Idx x = i;
+        while (m_parent[x] != root) {
+            Idx next = m_parent[x];
+            mut(m_parent, x) = root;
+            x = next;
+        }
+    }
+    m_is_flat = true;
 }
 
-template <typename Idx>
-Idx IterableUnionFind<Idx>::class_root(Idx x) const
+template <typename Idx, typename Aggregate, typename Storage>
+bool IterableUnionFind<Idx, Aggregate, Storage>::is_flat() const noexcept
+{
+    return m_is_flat;
+}
+
+template <typename Idx, typename Aggregate, typename Storage>
+const Aggregate& IterableUnionFind<Idx, Aggregate, Storage>::class_aggregate(Idx x) const
+{
+    static_assert(has_aggregate,
+                  "IterableUnionFind::class_aggregate: no Aggregate type was given");
+    return m_aggregate[class_root(x)];
+}
+
+template <typename Idx, typename Aggregate, typename Storage>
+Idx IterableUnionFind<Idx, Aggregate, Storage>::class_root(Idx x) const
 {
     validate_index(x);
-    while (m_nodes[x].parent != x) {
-        x = m_nodes[x].parent;
+    if (m_is_flat) {
+        return m_parent[x];
+    }
+    while (m_parent[x] != x) {
+        x = m_parent[x];
     }
     return x;
 }
 
-template <typename Idx>
-void IterableUnionFind<Idx>::get_class_members(Idx x, std::vector<Idx>& out) const
+template <typename Idx, typename Aggregate, typename Storage>
+void IterableUnionFind<Idx, Aggregate, Storage>::find_batch(const Idx* elements, Idx* out_roots, size_t count) const
+{
+    for (size_t i = 0; i < count; ++i) {
+        validate_index(elements[i]);
+    }
+
+    // How far ahead to prefetch, and how many walks to interleave
+    constexpr size_t lanes = 16;
+
+    if (m_is_flat) {
+        for (size_t i = 0; i < count; ++i) {
+            if (i + lanes < count) {
+                __builtin_prefetch(&m_parent[elements[i + lanes]]);
+            }
+            out_roots[i] = m_parent[elements[i]];
+        }
+        return;
+    }
+
+    // Each lane walks one element to its root. When a walk finishes, its lane
+    // takes the next element, so every lane always has a load outstanding.
+    size_t position[lanes];
+    Idx current[lanes];
+    size_t active = 0;
+    size_t next_input = 0;
+    for (; active < lanes && next_input < count; ++active, ++next_input) {
+        position[active] = next_input;
+        current[active] = elements[next_input];
+        __builtin_prefetch(&m_parent[current[active]]);
+    }
+    while (active > 0) {
+        for (size_t lane = 0; lane < active;) {
+            const Idx x = current[lane];
+            const Idx parent = m_parent[x];
+            if (parent != x) {
+                current[lane] = parent;
+                __builtin_prefetch(&m_parent[parent]);
+                ++lane;
+                continue;
+            }
+            // Written after elements[position[lane]] was last read, so
+            // out_roots may alias elements
+            out_roots[position[lane]] = x;
+            if (next_input < count) {
+                position[lane] = next_input;
+                current[lane] = elements[next_input];
+                __builtin_prefetch(&m_parent[current[lane]]);
+                ++next_input;
+                ++lane;
+            } else {
+                // Retire the lane by moving the last active lane into it
+                --active;
+                position[lane] = position[active];
+                current[lane] = current[active];
+            }
+        }
+    }
+}
+
+template <typename Idx, typename Aggregate, typename Storage>
+void IterableUnionFind<Idx, Aggregate, Storage>::get_class_members(Idx x, std::vector<Idx>& out) const
 {
     validate_index(x);
     out.clear();
     Idx current = x;
     do {
         out.push_back(current);
-        current = m_nodes[current].next;
+        current = m_next[current];
     } while (current != x);
 }
 
-template <typename Idx>
-bool IterableUnionFind<Idx>::same_class(Idx a, Idx b) const
+template <typename Idx, typename Aggregate, typename Storage>
+bool IterableUnionFind<Idx, Aggregate, Storage>::same_class(Idx a, Idx b) const
 {
     return class_root(a) == class_root(b);
 }
@@ -213,31 +534,89 @@ bool IterableUnionFind<Idx>::same_class(Idx a, Idx b) const
 // Class enumeration
 // =============================================================================
 
-template <typename Idx>
-Idx IterableUnionFind<Idx>::num_classes() const
+template <typename Idx, typename Aggregate, typename Storage>
+void IterableUnionFind<Idx, Aggregate, Storage>::enable_root_list()
 {
-    Idx count = 0;
-    for (Idx i = 0; i < static_cast<Idx>(m_nodes.size()); ++i) {
-        if (m_nodes[i].parent == i) {
-            ++count;
+    if (m_has_root_list) {
+        return;
+    }
+    const size_t n = m_parent.size();
+    m_root_pos.resize(n);
+    m_roots.clear();
+    m_roots.reserve(m_class_count);
+    m_has_root_list = true;
+    for (size_t i = 0; i < n; ++i) {
+        if (m_parent[i] == static_cast<Idx>(i)) {
+            add_root(static_cast<Idx>(i));
         }
     }
-    return count;
 }
 
-template <typename Idx>
-void IterableUnionFind<Idx>::get_class_representatives(std::vector<Idx>& out_roots) const
+template <typename Idx, typename Aggregate, typename Storage>
+bool IterableUnionFind<Idx, Aggregate, Storage>::has_root_list() const noexcept
+{
+    return m_has_root_list;
+}
+
+template <typename Idx, typename Aggregate, typename Storage>
+Idx IterableUnionFind<Idx, Aggregate, Storage>::num_classes() const
+{
+    return m_class_count;
+}
+
+template <typename Idx, typename Aggregate, typename Storage>
+void IterableUnionFind<Idx, Aggregate, Storage>::get_class_representatives(std::vector<Idx>& out_roots) const
 {
+    if (m_has_root_list) {
+        out_roots.resize(m_roots.size());
+        for (size_t k = 0; k < m_roots.size(); ++k) {
+            out_roots[k] = m_roots[k];
+        }
+        std::sort(out_roots.begin(), out_roots.end());
+        return;
+    }
     out_roots.clear();
-    for (Idx i = 0; i < static_cast<Idx>(m_nodes.size()); ++i) {
-        if (m_nodes[i].parent == i) {
+    for (Idx i = 0; i < static_cast<Idx>(m_parent.size()); ++i) {
+        if (m_parent[i] == i) {
             out_roots.push_back(i);
         }
     }
 }
 
-template <typename Idx>
-void IterableUnionFind<Idx>::get_classes(std::vector<std::vector<Idx>>& out_classes) const
+template <typename Idx, typename Aggregate, typename Storage>
+void IterableUnionFind<Idx, Aggregate, Storage>::get_roots(std::vector<Idx>& out_roots) const
+{
+    const Idx n = static_cast<Idx>(m_parent.size());
+    if (m_is_flat) {
+        out_roots.resize(m_parent.size());
+        for (Idx i = 0; i < n; ++i) {
+            out_roots[i] = m_parent[i];
+        }
+        return;
+    }
+
+    // Indices are below Idx::max (see make_set), so it marks an unknown root
+    constexpr Idx unknown = std::numeric_limits<Idx>::max();
+    out_roots.assign(m_parent.size(), unknown);
+    for (Idx i = 0; i < n; ++i) {
+        if (out_roots[i] != unknown) {
+            continue;
+        }
+        // Walk up to a root, or to an element whose root is already known
+        Idx top = i;
+        while (out_roots[top] == unknown && m_parent[top] != top) {
+            top = m_parent[top];
+        }
+        const Idx root = (out_roots[top] != unknown) ? out_roots[top] : top;
+        for (Idx x = i; x != top; x = m_parent[x]) {
+            out_roots[x] = root;
+        }
+        out_roots[top] = root;
+    }
+}
+
+template <typename Idx, typename Aggregate, typename Storage>
+void IterableUnionFind<Idx, Aggregate, Storage>::get_classes(std::vector<std::vector<Idx>>& out_classes) const
 {
     out_classes.clear();
     std::vector<Idx> roots;
@@ -249,27 +628,207 @@ void IterableUnionFind<Idx>::get_classes(std::vector<std::vector<Idx>>& out_clas
     }
 }
 
+template <typename Idx, typename Aggregate, typename Storage>
+Idx IterableUnionFind<Idx, Aggregate, Storage>::relabel_dense(std::vector<Idx>& element_to_class) const
+{
+    // Roots first, then each root's class index on its first appearance
+    get_roots(element_to_class);
+    constexpr Idx unassigned = std::numeric_limits<Idx>::max();
+    std::vector<Idx> root_to_class(m_parent.size(), unassigned);
+    Idx class_count = 0;
+    for (Idx& entry : element_to_class) {
+        Idx& cls = root_to_class[entry];
+        if (cls == unassigned) {
+            cls = class_count++;
+        }
+        entry = cls;
+    }
+    return class_count;
+}
+
+template <typename Idx, typename Aggregate, typename Storage>
+void IterableUnionFind<Idx, Aggregate, Storage>::export_classes_csr(std::vector<size_t>& out_offsets,
+                                                           std::vector<Idx>& out_members) const
+{
+    std::vector<Idx> element_to_class;
+    relabel_dense(element_to_class);
+    export_classes_csr(element_to_class, out_offsets, out_members);
+}
+
+template <typename Idx, typename Aggregate, typename Storage>
+void IterableUnionFind<Idx, Aggregate, Storage>::export_classes_csr(const std::vector<Idx>& element_to_class,
+                                                           std::vector<size_t>& out_offsets,
+                                                           std::vector<Idx>& out_members) const
+{
+    if (element_to_class.size() != m_parent.size()) {
+        throw std::invalid_argument(
+            "IterableUnionFind::export_classes_csr: expected " +
+            std::to_string(m_parent.size()) + " class indices, got " +
+            std::to_string(element_to_class.size()));
+    }
+
+    // Pass 1: count members; dense numbering means each new class is the next one
+    out_offsets.assign(1, 0);
+    for (size_t i = 0; i < element_to_class.size(); ++i) {
+        const size_t cls = static_cast<size_t>(element_to_class[i]);
+        if (cls + 1 == out_offsets.size()) {
+            out_offsets.push_back(0);
+        } else if (cls + 1 > out_offsets.size()) {
+            throw std::invalid_argument(
+                "IterableUnionFind::export_classes_csr: class index " + std::to_string(cls) +
+                " of element " + std::to_string(i) +
+                " is not dense in first-appearance order");
+        }
+        ++out_offsets[cls + 1];
+    }
+    const size_t class_count = out_offsets.size() - 1;
+    for (size_t c = 1; c <= class_count; ++c) {
+        out_offsets[c] += out_offsets[c - 1];
+    }
+
+    // Pass 2: scatter in element order, advancing out_offsets[c] as the write
+    // cursor of class c, which leaves it at the start of class c + 1; then
+    // shift back by one.
+    out_members.resize(m_parent.size());
+    for (size_t i = 0; i < element_to_class.size(); ++i) {
+        out_members[out_offsets[element_to_class[i]]++] = static_cast<Idx>(i);
+    }
+    for (size_t c = class_count; c > 0; --c) {
+        out_offsets[c] = out_offsets[c - 1];
+    }
+    out_offsets[0] = 0;
+}
+
+// =============================================================================
+// Checkpoints
+// =============================================================================
+
+template <typename Idx, typename Aggregate, typename Storage>
+typename IterableUnionFind<Idx, Aggregate, Storage>::Checkpoint IterableUnionFind<Idx, Aggregate, Storage>::checkpoint()
+{
+    const size_t serial = m_next_checkpoint_serial++;
+    m_open_checkpoints.push_back(serial);
+    return Checkpoint{serial, m_undo_log.size(), m_parent.size(), m_is_flat};
+}
+
+template <typename Idx, typename Aggregate, typename Storage>
+void IterableUnionFind<Idx, Aggregate, Storage>::rollback(const Checkpoint& cp)
+{
+    validate_checkpoint(cp, "rollback");
+
+    // Undo unions newest first; each one exactly reverses unite()
+    while (m_undo_log.size() > cp.log_size) {
+        const UndoRecord& r = m_undo_log.back();
+        mut(m_parent, r.old_root) = r.old_root;
+        if (r.rank_incremented) {
+            --mut(m_rank, r.new_root);
+        }
+        mut(m_size, r.new_root) -= r.old_root_size;
+        mut(m_size, r.old_root) = r.old_root_size;
+        // The splice is a swap of the two roots' next pointers, its own inverse
+        std::swap(mut(m_next, r.new_root), mut(m_next, r.old_root));
+        ++m_class_count;
+        if (m_has_root_list) {
+            add_root(r.old_root);
+        }
+        if constexpr (has_aggregate) {
+            mut(m_aggregate, r.new_root) = std::move(m_aggregate_undo.back());
+            m_aggregate_undo.pop_back();
+        }
+        m_undo_log.pop_back();
+    }
+
+    // Elements created since the checkpoint are now singletons; drop them
+    m_class_count -= static_cast<Idx>(m_parent.size() - cp.element_count);
+    if (m_has_root_list) {
+        for (size_t i = m_parent.size(); i > cp.element_count; --i) {
+            remove_root(static_cast<Idx>(i - 1));
+        }
+        m_root_pos.resize(cp.element_count);
+    }
+    m_parent.resize(cp.element_count);
+    m_rank.resize(cp.element_count);
+    m_size.resize(cp.element_count);
+    m_next.resize(cp.element_count);
+    if constexpr (has_aggregate) {
+        m_aggregate.resize(cp.element_count);
+    }
+
+    m_is_flat = cp.is_flat;
+    m_open_checkpoints.pop_back();
+}
+
+template <typename Idx, typename Aggregate, typename Storage>
+void IterableUnionFind<Idx, Aggregate, Storage>::commit(const Checkpoint& cp)
+{
+    validate_checkpoint(cp, "commit");
+    m_open_checkpoints.pop_back();
+    if (m_open_checkpoints.empty()) {
+        m_undo_log.clear();
+        m_aggregate_undo.clear();
+    }
+}
+
+template <typename Idx, typename Aggregate, typename Storage>
+size_t IterableUnionFind<Idx, Aggregate, Storage>::checkpoint_depth() const noexcept
+{
+    return m_open_checkpoints.size();
+}
+
 // =========================================================================
 // Full state management
 // =========================================================================
-
-template <typename Idx>
-void IterableUnionFind<Idx>::export_nodes(std::vector<Node>& out) const
+template <typename Idx, typename Aggregate, typename Storage>
+void IterableUnionFind<Idx, Aggregate, Storage>::export_nodes(std::vector<Node>& out) const
 {
-    out = m_nodes;
+    const size_t n = m_parent.size();
+    out.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = Node{m_parent[i], static_cast<Idx>(m_rank[i]), m_size[i], m_next[i]};
+    }
 }
 
 // =============================================================================
 // Private Helpers
 // =============================================================================
 
-template <typename Idx>
-void IterableUnionFind<Idx>::validate_index(Idx x) const
+template <typename Idx, typename Aggregate, typename Storage>
+void IterableUnionFind<Idx, Aggregate, Storage>::add_root(Idx x)
+{
+    mut(m_root_pos, x) = static_cast<Idx>(m_roots.size());
+    m_roots.push_back(x);
+}
+
+template <typename Idx, typename Aggregate, typename Storage>
+void IterableUnionFind<Idx, Aggregate, Storage>::remove_root(Idx x)
+{
+    // Move the last root into x's slot
+    const Idx pos = m_root_pos[x];
+    const Idx last = m_roots[m_roots.size() - 1];
+    mut(m_roots, pos) = last;
+    mut(m_root_pos, last) = pos;
+    m_roots.pop_back();
+}
+
+template <typename Idx, typename Aggregate, typename Storage>
+void IterableUnionFind<Idx, Aggregate, Storage>::validate_checkpoint(const Checkpoint& cp, const char* caller) const
+{
+    // The serial, not the depth, identifies cp: a closed checkpoint has the
+    // depth of the next one opened at the same level
+    if (m_open_checkpoints.empty() || cp.serial != m_open_checkpoints.back()) {
+        throw std::logic_error(
+            std::string("IterableUnionFind::") + caller +
+            ": checkpoint is not the innermost open checkpoint");
+    }
+}
+
+template <typename Idx, typename Aggregate, typename Storage>
+void IterableUnionFind<Idx, Aggregate, Storage>::validate_index(Idx x) const
 {
-    if (static_cast<size_t>(x) >= m_nodes.size()) {
+    if (static_cast<size_t>(x) >= m_parent.size()) {
         throw std::runtime_error(
             "IterableUnionFind: index " + std::to_string(x) +
-            " out of range [0, " + std::to_string(m_nodes.size()) + ")");
+            " out of range [0, " + std::to_string(m_parent.size()) + ")");
     }
 }
 
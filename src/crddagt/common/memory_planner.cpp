@@ -0,0 +1,324 @@
+/**
+ * @file memory_planner.cpp
+ */
+#include "crddagt/common/memory_planner.hpp"
+#include "crddagt/common/step_graph_algorithms.hpp"
+
+#include <algorithm>
+
+namespace crddagt
+{
+
+namespace
+{
+
+/// Upper bound on the reachability bitsets of one column block.
+constexpr size_t reach_block_budget_bytes = size_t{32} << 20;
+
+constexpr size_t no_index = std::numeric_limits<size_t>::max();
+
+/// Rows of equal-width bitsets in one allocation.
+class BitMatrix
+{
+public:
+    BitMatrix(size_t rows, size_t columns)
+        : m_words((columns + 63) / 64)
+        , m_columns(columns)
+        , m_bits(rows * m_words, 0)
+    {
+    }
+
+    size_t words() const { return m_words; }
+    uint64_t* row(size_t r) { return &m_bits[r * m_words]; }
+    const uint64_t* row(size_t r) const { return &m_bits[r * m_words]; }
+
+    /// The first set column >= from in row r, or the column count if none.
+    size_t next_set(size_t r, size_t from) const
+    {
+        const uint64_t* bits = row(r);
+        for (size_t w = from / 64; w < m_words; ++w)
+        {
+            uint64_t word = bits[w];
+            if (w == from / 64)
+            {
+                word &= ~uint64_t{0} << (from % 64);
+            }
+            if (word != 0)
+            {
+                return std::min(m_columns, w * 64 + static_cast<size_t>(__builtin_ctzll(word)));
+            }
+        }
+        return m_columns;
+    }
+
+private:
+    size_t m_words;
+    size_t m_columns;
+    std::vector<uint64_t> m_bits;
+};
+
+/// Maximum matching in the bipartite graph given by precedes (left row, right
+/// column), by Hopcroft-Karp. Returns the matched right vertex of each left vertex.
+std::vector<size_t> max_matching(const BitMatrix& precedes, size_t n)
+{
+    std::vector<size_t> match_left(n, no_index);
+    std::vector<size_t> match_right(n, no_index);
+    std::vector<size_t> dist(n);
+    std::vector<size_t> cursor(n);
+    std::vector<size_t> queue;
+    struct Frame
+    {
+        size_t u;
+        size_t v;
+    };
+    std::vector<Frame> stack;
+
+    while (true)
+    {
+        // BFS layers from the free left vertices
+        queue.clear();
+        for (size_t u = 0; u < n; ++u)
+        {
+            dist[u] = (match_left[u] == no_index) ? 0 : no_index;
+            if (dist[u] == 0)
+            {
+                queue.push_back(u);
+            }
+        }
+        bool found_free = false;
+        for (size_t head = 0; head < queue.size(); ++head)
+        {
+            size_t u = queue[head];
+            for (size_t v = precedes.next_set(u, 0); v < n; v = precedes.next_set(u, v + 1))
+            {
+                size_t w = match_right[v];
+                if (w == no_index)
+                {
+                    found_free = true;
+                }
+                else if (dist[w] == no_index)
+                {
+                    dist[w] = dist[u] + 1;
+                    queue.push_back(w);
+                }
+            }
+        }
+        if (!found_free)
+        {
+            break;
+        }
+
+        // Vertex-disjoint augmenting paths along the layers, by iterative DFS
+        std::fill(cursor.begin(), cursor.end(), 0);
+        for (size_t root = 0; root < n; ++root)
+        {
+            if (match_left[root] != no_index)
+            {
+                continue;
+            }
+            stack.clear();
+            stack.push_back({root, no_index});
+            while (!stack.empty())
+            {
+                size_t u = stack.back().u;
+                size_t v = (dist[u] == no_index) ? n : precedes.next_set(u, cursor[u]);
+                if (v >= n)
+                {
+                    dist[u] = no_index; // dead end for the rest of this phase
+                    stack.pop_back();
+                    continue;
+                }
+                cursor[u] = v + 1;
+                size_t w = match_right[v];
+                if (w == no_index)
+                {
+                    stack.back().v = v;
+                    for (const Frame& frame : stack)
+                    {
+                        match_left[frame.u] = frame.v;
+                        match_right[frame.v] = frame.u;
+                    }
+                    break;
+                }
+                if (dist[w] != no_index && dist[w] == dist[u] + 1)
+                {
+                    stack.back().v = v;
+                    stack.push_back({w, no_index});
+                }
+            }
+        }
+    }
+    return match_left;
+}
+
+} // namespace
+
+std::shared_ptr<MemoryPlan> plan_memory(
+    const ExportedGraph& exported,
+    const std::unordered_map<std::type_index, size_t>& type_sizes)
+{
+    const size_t step_count = exported.step_count;
+    const size_t data_count = exported.data_infos.size();
+
+    std::vector<size_t> offsets;
+    std::vector<StepIdx> targets;
+    build_step_csr(step_count, exported.combined_step_links, offsets, targets);
+    std::vector<StepIdx> order;
+    if (!topological_sort(step_count, exported.combined_step_links, order))
+    {
+        throw std::invalid_argument("plan_memory: links contain a cycle");
+    }
+
+    // Creating step and lifetime-ending steps of each data object
+    std::vector<StepIdx> create_step(data_count, no_index);
+    std::vector<size_t> end_offsets{0};
+    std::vector<StepIdx> end_steps;
+    for (DataIdx d = 0; d < data_count; ++d)
+    {
+        const DataInfo& info = exported.data_infos[d];
+        StepIdx destroy_step = no_index;
+        const size_t first_end = end_steps.size();
+        for (const auto& [sidx, fidx, usage] : info.field_usages)
+        {
+            if (sidx >= step_count)
+            {
+                throw std::out_of_range("plan_memory: step " + std::to_string(sidx) +
+                                        " out of range [0, " + std::to_string(step_count) + ")");
+            }
+            if (usage == Usage::Create)
+            {
+                create_step[d] = sidx;
+            }
+            else if (usage == Usage::Destroy)
+            {
+                destroy_step = sidx;
+            }
+            end_steps.push_back(sidx);
+        }
+        if (create_step[d] == no_index)
+        {
+            throw std::invalid_argument("plan_memory: data " + std::to_string(d) +
+                                        " has no Create field");
+        }
+        if (destroy_step != no_index)
+        {
+            end_steps.resize(first_end);
+            end_steps.push_back(destroy_step);
+        }
+        end_offsets.push_back(end_steps.size());
+    }
+
+    // Group data objects by type, in order of first appearance
+    auto result = std::make_shared<MemoryPlan>();
+    MemoryPlan& plan = *result;
+    std::unordered_map<std::type_index, size_t> type_slot;
+    std::vector<std::vector<DataIdx>> type_members;
+    for (DataIdx d = 0; d < data_count; ++d)
+    {
+        const std::type_index ti = exported.data_infos[d].ti;
+        auto [it, inserted] = type_slot.emplace(ti, plan.per_type.size());
+        if (inserted)
+        {
+            auto size_it = type_sizes.find(ti);
+            const size_t object_size = (size_it != type_sizes.end()) ? size_it->second : 0;
+            plan.per_type.push_back(TypeMemoryPlan{ti, object_size, 0, 0});
+            type_members.emplace_back();
+        }
+        type_members[it->second].push_back(d);
+    }
+
+    plan.data_slots.assign(data_count, no_index);
+    plan.slot_offsets.push_back(0);
+    for (size_t t = 0; t < plan.per_type.size(); ++t)
+    {
+        const std::vector<DataIdx>& members = type_members[t];
+        const size_t n = members.size();
+
+        // precedes(i, j): member i precedes member j. Computed over column
+        // blocks of members: reach[s] holds the block members whose creating
+        // step is strictly reachable from step s.
+        BitMatrix precedes(n, n);
+        const size_t total_words = precedes.words();
+        const size_t budget_words =
+            std::max<size_t>(1, reach_block_budget_bytes / 8 / std::max<size_t>(1, step_count));
+        const size_t block_words = std::min(total_words, budget_words);
+        const size_t block_bits = block_words * 64;
+        std::vector<uint64_t> reach(step_count * block_words);
+        std::vector<uint64_t> created(step_count * block_words);
+        for (size_t lo = 0; lo < n; lo += block_bits)
+        {
+            const size_t hi = std::min(n, lo + block_bits);
+            std::fill(reach.begin(), reach.end(), 0);
+            std::fill(created.begin(), created.end(), 0);
+            for (size_t j = lo; j < hi; ++j)
+            {
+                created[create_step[members[j]] * block_words + (j - lo) / 64] |=
+                    uint64_t{1} << ((j - lo) % 64);
+            }
+            for (size_t p = step_count; p-- > 0;)
+            {
+                StepIdx u = order[p];
+                uint64_t* ru = &reach[u * block_words];
+                for (size_t i = offsets[u]; i < offsets[u + 1]; ++i)
+                {
+                    const uint64_t* rv = &reach[targets[i] * block_words];
+                    const uint64_t* cv = &created[targets[i] * block_words];
+                    for (size_t w = 0; w < block_words; ++w)
+                    {
+                        ru[w] |= rv[w] | cv[w];
+                    }
+                }
+            }
+            for (size_t i = 0; i < n; ++i)
+            {
+                const DataIdx d = members[i];
+                uint64_t* row = precedes.row(i) + lo / 64;
+                const size_t row_words = (hi - lo + 63) / 64;
+                std::copy_n(&reach[end_steps[end_offsets[d]] * block_words], row_words, row);
+                for (size_t e = end_offsets[d] + 1; e < end_offsets[d + 1]; ++e)
+                {
+                    const uint64_t* re = &reach[end_steps[e] * block_words];
+                    for (size_t w = 0; w < row_words; ++w)
+                    {
+                        row[w] &= re[w];
+                    }
+                }
+            }
+        }
+
+        // Minimum chain cover: follow matched pairs from each unmatched head
+        std::vector<size_t> next = max_matching(precedes, n);
+        std::vector<bool> has_prev(n, false);
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (next[i] != no_index)
+            {
+                has_prev[next[i]] = true;
+            }
+        }
+        TypeMemoryPlan& type = plan.per_type[t];
+        type.data_count = n;
+        for (size_t head = 0; head < n; ++head)
+        {
+            if (has_prev[head])
+            {
+                continue;
+            }
+            const size_t slot = plan.slot_types.size();
+            plan.slot_types.push_back(type.ti);
+            for (size_t i = head; i != no_index; i = next[i])
+            {
+                plan.data_slots[members[i]] = slot;
+                plan.slot_data.push_back(members[i]);
+            }
+            plan.slot_offsets.push_back(plan.slot_data.size());
+            ++type.slot_count;
+        }
+        plan.bytes_without_sharing += type.data_count * type.object_size;
+        plan.bytes_with_sharing += type.slot_count * type.object_size;
+    }
+
+    return result;
+}
+
+} // namespace crddagt
@@ -0,0 +1,98 @@
+/**
+ * @file memory_planner.hpp
+ * @brief Assignment of data objects to shared storage slots.
+ */
+#pragma once
+#include "crddagt/common/common.hpp"
+#include "crddagt/common/graph_core_enums.hpp"
+#include "crddagt/common/exported_graph.hpp"
+
+namespace crddagt
+{
+
+/**
+ * @brief Storage savings for the data objects of one type.
+ */
+struct TypeMemoryPlan
+{
+    std::type_index ti;
+
+    /// The size of one object of this type, as supplied. 0 if not supplied.
+    size_t object_size;
+
+    /// The number of data objects of this type.
+    size_t data_count;
+
+    /// The number of slots they are assigned to.
+    size_t slot_count;
+};
+
+/**
+ * @brief An assignment of data objects to storage slots that is safe in every schedule.
+ *
+ * @details
+ * Data objects that share a slot are of the same type and are totally ordered
+ * by the graph: every use of one happens before the creation of the next, in
+ * every execution order the step links allow. An executor can therefore give
+ * each slot one buffer and construct each data object in its slot's buffer.
+ */
+struct MemoryPlan
+{
+    /// The slot of each data object, indexed by data object index.
+    std::vector<size_t> data_slots;
+
+    /// The type of each slot.
+    std::vector<std::type_index> slot_types;
+
+    /// Offsets into `slot_data`, one per slot plus one.
+    std::vector<size_t> slot_offsets;
+
+    /// The data objects of each slot, in the order they occupy it.
+    std::vector<DataIdx> slot_data;
+
+    /// Per-type counts, in order of first appearance in `data_infos`.
+    std::vector<TypeMemoryPlan> per_type;
+
+    /// Total bytes with one buffer per data object.
+    size_t bytes_without_sharing = 0;
+
+    /// Total bytes with one buffer per slot.
+    size_t bytes_with_sharing = 0;
+
+    size_t slot_count() const { return slot_types.size(); }
+};
+
+/**
+ * @brief Assigns the data objects of an exported graph to the fewest storage slots.
+ *
+ * @details
+ * Data object A precedes data object B if they have the same type, and every
+ * step that ends A's lifetime happens before B's creating step through the
+ * combined step links. A's lifetime ends at its Destroy step if it has one,
+ * otherwise at its creating step and all its readers. A step that ends A and
+ * creates B does not qualify, since both are in use while it runs.
+ *
+ * Precedence is a partial order, and objects that share a slot must form a
+ * chain in it, so the fewest slots for a type is the size of a minimum chain
+ * cover. It is found as the number of objects minus a maximum bipartite
+ * matching (Hopcroft-Karp) over the precedence pairs.
+ *
+ * @par Cost
+ * Reachability to the creating steps is computed with bitsets in column blocks
+ * of bounded size. Per type with D objects, time is O((V + E) * D / 64) for the
+ * reachability plus O(D^2 * sqrt(D)) worst case for the matching, and the
+ * precedence relation takes D^2 / 8 bytes.
+ *
+ * @param exported The exported graph. Its combined step links must be acyclic.
+ * @param type_sizes The size in bytes of one object of each type, for the byte
+ *        totals. Types that are missing count as zero bytes.
+ * @return Shared pointer to the plan.
+ * @throw std::invalid_argument if the links contain a cycle or a data object
+ *        has no Create field.
+ * @throw std::out_of_range if a step index is not less than `exported.step_count`.
+ */
+std::shared_ptr<MemoryPlan> plan_memory(
+    const ExportedGraph& exported,
+    const std::unordered_map<std::type_index, size_t>& type_sizes = {});
+
+} // namespace crddagt
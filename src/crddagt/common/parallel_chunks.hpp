@@ -0,0 +1,67 @@
+/**
+ * @file parallel_chunks.hpp
+ * @brief Runs a loop body over fixed-size chunks of an index range on several threads.
+ */
+#pragma once
+#include "crddagt/common/common.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace crddagt
+{
+
+/**
+ * @brief Runs body(begin, end) over fixed-size chunks of [0, item_count).
+ *
+ * @details
+ * Workers claim chunks of 4096 items from a shared counter until none are
+ * left, so uneven chunks balance out. The calling thread is one of the
+ * workers; no thread is started if there is at most one chunk. The chunks
+ * passed to body are disjoint and cover the range exactly, but run in no
+ * particular order.
+ *
+ * @param item_count The number of items.
+ * @param num_threads The maximum number of threads, including the caller.
+ *        0 means hardware concurrency.
+ * @param body Called as body(begin, end), possibly concurrently.
+ */
+template <typename Body>
+void run_in_chunks(size_t item_count, size_t num_threads, Body&& body)
+{
+    constexpr size_t chunk_size = 4096;
+    const size_t chunk_count = (item_count + chunk_size - 1) / chunk_size;
+    if (num_threads == 0)
+    {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    num_threads = std::min(num_threads, chunk_count);
+
+    std::atomic<size_t> next_chunk{0};
+    auto worker = [&]()
+    {
+        for (size_t chunk = next_chunk++; chunk < chunk_count; chunk = next_chunk++)
+        {
+            body(chunk * chunk_size, std::min(item_count, (chunk + 1) * chunk_size));
+        }
+    };
+    if (num_threads <= 1)
+    {
+        worker();
+        return;
+    }
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads - 1);
+    for (size_t t = 1; t < num_threads; ++t)
+    {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+} // namespace crddagt
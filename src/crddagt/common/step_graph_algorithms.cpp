@@ -0,0 +1,324 @@
+/**
+ * @file step_graph_algorithms.cpp
+ */
+#include "crddagt/common/step_graph_algorithms.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace crddagt
+{
+
+namespace
+{
+
+/// Upper bound on the reachability bitsets of one column block, per thread.
+constexpr size_t reduction_block_budget_bytes = size_t{32} << 20;
+
+void validate_links(size_t step_count, const std::vector<StepLinkPair>& links, const char* caller)
+{
+    for (const auto& [before, after] : links)
+    {
+        if (before >= step_count || after >= step_count)
+        {
+            throw std::out_of_range(
+                std::string(caller) + ": link (" + std::to_string(before) + ", " +
+                std::to_string(after) + ") out of range [0, " + std::to_string(step_count) + ")");
+        }
+    }
+}
+
+/// build_step_csr() without index validation.
+void build_csr_unchecked(size_t step_count,
+                         const std::vector<StepLinkPair>& links,
+                         std::vector<size_t>& offsets,
+                         std::vector<StepIdx>& targets)
+{
+    offsets.assign(step_count + 1, 0);
+    for (const auto& [before, after] : links)
+    {
+        ++offsets[before + 1];
+    }
+    for (size_t s = 0; s < step_count; ++s)
+    {
+        offsets[s + 1] += offsets[s];
+    }
+    targets.resize(links.size());
+    std::vector<size_t> cursor(offsets.begin(), offsets.end() - 1);
+    for (const auto& [before, after] : links)
+    {
+        targets[cursor[before]++] = after;
+    }
+}
+
+bool topological_sort_csr(size_t step_count,
+                          const std::vector<size_t>& offsets,
+                          const std::vector<StepIdx>& targets,
+                          std::vector<StepIdx>& out_order)
+{
+    std::vector<size_t> in_degree(step_count, 0);
+    for (StepIdx t : targets)
+    {
+        ++in_degree[t];
+    }
+
+    // out_order doubles as the FIFO queue of ready steps
+    out_order.clear();
+    out_order.reserve(step_count);
+    for (StepIdx s = 0; s < step_count; ++s)
+    {
+        if (in_degree[s] == 0)
+        {
+            out_order.push_back(s);
+        }
+    }
+    for (size_t head = 0; head < out_order.size(); ++head)
+    {
+        StepIdx s = out_order[head];
+        for (size_t i = offsets[s]; i < offsets[s + 1]; ++i)
+        {
+            if (--in_degree[targets[i]] == 0)
+            {
+                out_order.push_back(targets[i]);
+            }
+        }
+    }
+    return out_order.size() == step_count;
+}
+
+} // namespace
+
+void build_step_csr(size_t step_count,
+                    const std::vector<StepLinkPair>& links,
+                    std::vector<size_t>& out_offsets,
+                    std::vector<StepIdx>& out_targets)
+{
+    validate_links(step_count, links, "build_step_csr");
+    build_csr_unchecked(step_count, links, out_offsets, out_targets);
+}
+
+bool topological_sort(size_t step_count,
+                      const std::vector<StepLinkPair>& links,
+                      std::vector<StepIdx>& out_order)
+{
+    validate_links(step_count, links, "topological_sort");
+    std::vector<size_t> offsets;
+    std::vector<StepIdx> targets;
+    build_csr_unchecked(step_count, links, offsets, targets);
+    return topological_sort_csr(step_count, offsets, targets, out_order);
+}
+
+void compute_step_levels(size_t step_count,
+                         const std::vector<StepLinkPair>& links,
+                         const std::vector<StepIdx>& order,
+                         std::vector<size_t>& out_levels)
+{
+    validate_links(step_count, links, "compute_step_levels");
+    if (order.size() != step_count)
+    {
+        throw std::invalid_argument(
+            "compute_step_levels: order has " + std::to_string(order.size()) +
+            " steps, expected " + std::to_string(step_count));
+    }
+
+    std::vector<size_t> offsets;
+    std::vector<StepIdx> targets;
+    build_csr_unchecked(step_count, links, offsets, targets);
+
+    // Relax along the topological order: all predecessors of a step are
+    // final before the step itself is visited.
+    out_levels.assign(step_count, 0);
+    std::vector<bool> seen(step_count, false);
+    for (StepIdx s : order)
+    {
+        if (s >= step_count || seen[s])
+        {
+            throw std::invalid_argument("compute_step_levels: order is not a permutation");
+        }
+        seen[s] = true;
+        size_t next_level = out_levels[s] + 1;
+        for (size_t i = offsets[s]; i < offsets[s + 1]; ++i)
+        {
+            out_levels[targets[i]] = std::max(out_levels[targets[i]], next_level);
+        }
+    }
+}
+
+void group_steps_by_level(const std::vector<size_t>& levels,
+                          std::vector<size_t>& out_offsets,
+                          std::vector<StepIdx>& out_steps)
+{
+    size_t level_count = 0;
+    for (size_t level : levels)
+    {
+        if (level != excluded_step_level)
+        {
+            level_count = std::max(level_count, level + 1);
+        }
+    }
+
+    out_offsets.assign(level_count + 1, 0);
+    for (size_t level : levels)
+    {
+        if (level != excluded_step_level)
+        {
+            ++out_offsets[level + 1];
+        }
+    }
+    for (size_t k = 0; k < level_count; ++k)
+    {
+        out_offsets[k + 1] += out_offsets[k];
+    }
+    out_steps.resize(out_offsets[level_count]);
+    std::vector<size_t> cursor(out_offsets.begin(), out_offsets.end() - 1);
+    for (StepIdx s = 0; s < levels.size(); ++s)
+    {
+        if (levels[s] != excluded_step_level)
+        {
+            out_steps[cursor[levels[s]]++] = s;
+        }
+    }
+}
+
+size_t reduce_step_links(size_t step_count,
+                         std::vector<StepLinkPair>& links,
+                         size_t num_threads)
+{
+    validate_links(step_count, links, "reduce_step_links");
+    const size_t original_count = links.size();
+    if (links.empty())
+    {
+        return 0;
+    }
+
+    std::vector<size_t> offsets;
+    std::vector<StepIdx> targets;
+    build_csr_unchecked(step_count, links, offsets, targets);
+
+    std::vector<StepIdx> order;
+    if (!topological_sort_csr(step_count, offsets, targets, order))
+    {
+        throw std::invalid_argument("reduce_step_links: links contain a cycle");
+    }
+    std::vector<size_t> position(step_count);
+    for (size_t p = 0; p < step_count; ++p)
+    {
+        position[order[p]] = p;
+    }
+
+    // Sort each successor list by topological position, and mark duplicates.
+    // A successor w that reaches successor v always precedes v in this order.
+    for (StepIdx s = 0; s < step_count; ++s)
+    {
+        auto first = targets.begin() + offsets[s];
+        auto last = targets.begin() + offsets[s + 1];
+        std::sort(first, last, [&](StepIdx a, StepIdx b) { return position[a] < position[b]; });
+    }
+    // duplicate[] is read-only once the blocks start; redundant[i] is written
+    // only by the thread that owns the block containing targets[i].
+    std::vector<uint8_t> duplicate(targets.size(), 0);
+    for (StepIdx s = 0; s < step_count; ++s)
+    {
+        for (size_t i = offsets[s] + 1; i < offsets[s + 1]; ++i)
+        {
+            duplicate[i] = (targets[i] == targets[i - 1]);
+        }
+    }
+    std::vector<uint8_t> redundant(duplicate);
+
+    // Column blocks over topological positions. Within a block, reach[u] holds
+    // the steps in the block reachable from u (including u itself).
+    const size_t total_words = (step_count + 63) / 64;
+    const size_t budget_words = std::max<size_t>(1, reduction_block_budget_bytes / 8 / step_count);
+    const size_t block_words = std::min(total_words, budget_words);
+    const size_t block_bits = block_words * 64;
+    const size_t block_count = (step_count + block_bits - 1) / block_bits;
+
+    auto reduce_block = [&](size_t block, std::vector<uint64_t>& reach, std::vector<uint64_t>& cover)
+    {
+        const size_t lo = block * block_bits;
+        const size_t hi = std::min(step_count, lo + block_bits);
+        std::fill(reach.begin(), reach.end(), 0);
+
+        // Steps at positions >= hi reach nothing in this block
+        for (size_t p = hi; p-- > 0;)
+        {
+            StepIdx u = order[p];
+            std::fill(cover.begin(), cover.end(), 0);
+            for (size_t i = offsets[u]; i < offsets[u + 1]; ++i)
+            {
+                if (duplicate[i])
+                {
+                    continue; // duplicate; its reach is already in cover
+                }
+                StepIdx v = targets[i];
+                size_t pv = position[v];
+                if (pv >= lo && pv < hi && (cover[(pv - lo) / 64] >> ((pv - lo) % 64) & 1))
+                {
+                    redundant[i] = 1;
+                }
+                const uint64_t* rv = &reach[v * block_words];
+                for (size_t w = 0; w < block_words; ++w)
+                {
+                    cover[w] |= rv[w];
+                }
+            }
+            if (p >= lo)
+            {
+                cover[(p - lo) / 64] |= uint64_t{1} << ((p - lo) % 64);
+            }
+            std::copy(cover.begin(), cover.end(), reach.begin() + u * block_words);
+        }
+    };
+
+    if (num_threads == 0)
+    {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    num_threads = std::min(num_threads, block_count);
+
+    std::atomic<size_t> next_block{0};
+    auto worker = [&]()
+    {
+        std::vector<uint64_t> reach(step_count * block_words);
+        std::vector<uint64_t> cover(block_words);
+        for (size_t block = next_block++; block < block_count; block = next_block++)
+        {
+            reduce_block(block, reach, cover);
+        }
+    };
+    if (num_threads <= 1)
+    {
+        worker();
+    }
+    else
+    {
+        std::vector<std::thread> threads;
+        threads.reserve(num_threads - 1);
+        for (size_t t = 1; t < num_threads; ++t)
+        {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    links.clear();
+    for (StepIdx s = 0; s < step_count; ++s)
+    {
+        for (size_t i = offsets[s]; i < offsets[s + 1]; ++i)
+        {
+            if (!redundant[i])
+            {
+                links.emplace_back(s, targets[i]);
+            }
+        }
+    }
+    return original_count - links.size();
+}
+
+} // namespace crddagt
@@ -0,0 +1,107 @@
+/**
+ * @file step_graph_algorithms.hpp
+ * @brief Algorithms over step link lists, as found in ExportedGraph.
+ */
+#pragma once
+#include "crddagt/common/common.hpp"
+#include "crddagt/common/graph_core_enums.hpp"
+#include "crddagt/common/exported_graph.hpp"
+
+namespace crddagt
+{
+
+/**
+ * @brief Builds successor lists in compressed sparse row (CSR) form.
+ *
+ * The successors of step s are `out_targets[out_offsets[s] .. out_offsets[s + 1])`,
+ * in the order the links appear. Duplicates are kept.
+ *
+ * @param step_count The number of steps. All link endpoints must be less than this.
+ * @param links Step links as (before, after).
+ * @param out_offsets Output vector, replaced with `step_count + 1` offsets.
+ * @param out_targets Output vector, replaced with one entry per link.
+ * @throw std::out_of_range if a link endpoint is not less than step_count.
+ */
+void build_step_csr(size_t step_count,
+                    const std::vector<StepLinkPair>& links,
+                    std::vector<size_t>& out_offsets,
+                    std::vector<StepIdx>& out_targets);
+
+/**
+ * @brief Computes a topological order of steps using Kahn's algorithm.
+ *
+ * Steps with no predecessors are seeded in increasing index order, and the order
+ * is deterministic for a given link list.
+ *
+ * @param step_count The number of steps. All link endpoints must be less than this.
+ * @param links Step links as (before, after). Duplicates are allowed.
+ * @param out_order Output vector, replaced with the order. On failure, it holds
+ *        the steps that could be ordered before the cycle was hit.
+ * @return true if every step was ordered, false if the links contain a cycle.
+ * @throw std::out_of_range if a link endpoint is not less than step_count.
+ */
+bool topological_sort(size_t step_count,
+                      const std::vector<StepLinkPair>& links,
+                      std::vector<StepIdx>& out_order);
+
+/**
+ * @brief Computes the level of each step: the length of the longest path from a source.
+ *
+ * Steps without predecessors are at level 0. Every link (a, b) satisfies
+ * `level[a] < level[b]`, so the steps of one level can run concurrently.
+ *
+ * @param step_count The number of steps. All link endpoints must be less than this.
+ * @param links Step links as (before, after). Duplicates are allowed.
+ * @param order A topological order of all steps, e.g. from `topological_sort()`.
+ * @param out_levels Output vector, replaced with one level per step.
+ * @throw std::out_of_range if a link endpoint is not less than step_count.
+ * @throw std::invalid_argument if order is not a permutation of the steps.
+ * @pre order is consistent with links; otherwise levels are meaningless.
+ */
+void compute_step_levels(size_t step_count,
+                         const std::vector<StepLinkPair>& links,
+                         const std::vector<StepIdx>& order,
+                         std::vector<size_t>& out_levels);
+
+/**
+ * @brief Groups steps by level (a counting sort).
+ *
+ * The steps of level k are `out_steps[out_offsets[k] .. out_offsets[k + 1])`,
+ * in increasing step index order. Steps at `excluded_step_level` are left out.
+ *
+ * @param levels The level of each step, e.g. from `compute_step_levels()`.
+ * @param out_offsets Output vector, replaced with `level_count + 1` offsets.
+ * @param out_steps Output vector, replaced with all steps grouped by level.
+ */
+void group_steps_by_level(const std::vector<size_t>& levels,
+                          std::vector<size_t>& out_offsets,
+                          std::vector<StepIdx>& out_steps);
+
+/**
+ * @brief Removes duplicate and transitively implied links from an acyclic link list.
+ *
+ * A link (a, b) is implied if b is also reachable from a through some other path.
+ * The result is the transitive reduction, which is unique for a DAG and has the
+ * same reachability as the input.
+ *
+ * @details
+ * Reachability is computed over a topological order with bitsets. To bound memory
+ * for large graphs, the topological positions are processed in column blocks;
+ * each block needs `step_count` bitsets of the block width. Blocks are independent
+ * and are distributed across threads.
+ *
+ * Cost is O(E * V / 64) word operations in total, plus O(V + E) per block.
+ *
+ * @param step_count The number of steps. All link endpoints must be less than this.
+ * @param links Step links as (before, after), replaced with the reduced links,
+ *        grouped by `before` in increasing step index order.
+ * @param num_threads Number of worker threads. 0 means hardware concurrency.
+ * @return The number of links removed.
+ * @throw std::out_of_range if a link endpoint is not less than step_count.
+ * @throw std::invalid_argument if the links contain a cycle.
+ */
+size_t reduce_step_links(size_t step_count,
+                         std::vector<StepLinkPair>& links,
+                         size_t num_threads = 0);
+
+} // namespace crddagt
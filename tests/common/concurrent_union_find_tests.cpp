@@ -0,0 +1,116 @@
+/**
+ * @file concurrent_union_find_tests.cpp
+ * @brief Unit tests for ConcurrentUnionFind
+ */
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <thread>
+#include "crddagt/common/concurrent_union_find.inline.hpp"
+
+using namespace crddagt;
+
+TEST(ConcurrentUnionFindTests, Singletons) {
+    ConcurrentUnionFind<size_t> uf(4);
+    EXPECT_EQ(uf.element_count(), 4u);
+    for (size_t i = 0; i < 4; ++i) {
+        EXPECT_EQ(uf.find(i), i);
+        std::vector<size_t> members;
+        uf.get_class_members(i, members);
+        EXPECT_EQ(members, std::vector<size_t>{i});
+    }
+    EXPECT_FALSE(uf.same_class(0, 1));
+}
+
+TEST(ConcurrentUnionFindTests, Unite_ReportsMergeOnce) {
+    ConcurrentUnionFind<uint32_t> uf(5);
+    EXPECT_TRUE(uf.unite(0, 1));
+    EXPECT_TRUE(uf.unite(1, 2));
+    EXPECT_FALSE(uf.unite(2, 0));
+    EXPECT_TRUE(uf.same_class(0, 2));
+    EXPECT_FALSE(uf.same_class(0, 3));
+
+    std::vector<uint32_t> members;
+    uf.get_class_members(2, members);
+    std::sort(members.begin(), members.end());
+    EXPECT_EQ(members, (std::vector<uint32_t>{0, 1, 2}));
+}
+
+TEST(ConcurrentUnionFindTests, OutOfRange_Throws) {
+    ConcurrentUnionFind<size_t> uf(3);
+    EXPECT_THROW(uf.find(3), std::runtime_error);
+    EXPECT_THROW(uf.unite(0, 7), std::runtime_error);
+}
+
+TEST(ConcurrentUnionFindTests, FromIterable_KeepsPartition) {
+    IterableUnionFind<size_t> initial;
+    initial.init_sets(6);
+    initial.unite(0, 1);
+    initial.unite(2, 3);
+    initial.unite(0, 2);
+
+    ConcurrentUnionFind<size_t> uf(initial);
+    EXPECT_TRUE(uf.same_class(1, 3));
+    EXPECT_FALSE(uf.same_class(1, 4));
+    uf.unite(4, 5);
+
+    std::vector<size_t> members;
+    uf.get_class_members(3, members);
+    std::sort(members.begin(), members.end());
+    EXPECT_EQ(members, (std::vector<size_t>{0, 1, 2, 3}));
+}
+
+TEST(ConcurrentUnionFindTests, ConcurrentUnite_MatchesSequential) {
+    // Each thread links a strided share of a random edge list
+    constexpr size_t n = 20000;
+    constexpr size_t edge_count = 15000;
+    std::vector<std::pair<size_t, size_t>> edges;
+    uint64_t state = 12345;
+    auto next = [&state]() {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        return static_cast<size_t>((state >> 33) % n);
+    };
+    for (size_t e = 0; e < edge_count; ++e) {
+        edges.emplace_back(next(), next());
+    }
+
+    IterableUnionFind<size_t> expected;
+    expected.init_sets(n);
+    for (const auto& [a, b] : edges) {
+        expected.unite(a, b);
+    }
+
+    ConcurrentUnionFind<size_t> uf(n);
+    std::atomic<size_t> merges{0};
+    std::vector<std::thread> threads;
+    constexpr size_t thread_count = 4;
+    for (size_t t = 0; t < thread_count; ++t) {
+        threads.emplace_back([&, t]() {
+            for (size_t e = t; e < edges.size(); e += thread_count) {
+                if (uf.unite(edges[e].first, edges[e].second)) {
+                    ++merges;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(merges.load(), n - expected.num_classes());
+    IterableUnionFind<size_t> exported;
+    uf.export_to(exported);
+    EXPECT_TRUE(exported.is_flat());
+    EXPECT_EQ(exported.num_classes(), expected.num_classes());
+    for (size_t i = 0; i < n; ++i) {
+        EXPECT_EQ(exported.class_root(i), uf.class_root(i));
+        EXPECT_EQ(exported.class_size(i), expected.class_size(i));
+    }
+    for (const auto& [a, b] : edges) {
+        EXPECT_TRUE(exported.same_class(a, b));
+    }
+
+    // Member lists of the export are complete
+    std::vector<size_t> members;
+    exported.get_class_members(edges[0].first, members);
+    EXPECT_EQ(members.size(), expected.class_size(edges[0].first));
+}
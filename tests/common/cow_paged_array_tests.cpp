@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+#include "crddagt/common/cow_paged_array.hpp"
+
+using namespace crddagt;
+
+TEST(CowPagedArrayTests, PushBackAndResize_AcrossPages) {
+    CowPagedArray<int, 2> arr;  // 4 elements per page
+    for (int i = 0; i < 6; ++i) {
+        arr.push_back(i);
+    }
+    arr.resize(11, -1);
+    ASSERT_EQ(arr.size(), 11u);
+    for (size_t i = 0; i < 6; ++i) {
+        EXPECT_EQ(arr[i], static_cast<int>(i));
+    }
+    for (size_t i = 6; i < 11; ++i) {
+        EXPECT_EQ(arr[i], -1);
+    }
+
+    arr.resize(3);
+    arr.resize(5, 7);
+    EXPECT_EQ(arr[2], 2);
+    EXPECT_EQ(arr[3], 7);
+    EXPECT_EQ(arr[4], 7);
+
+    arr.clear();
+    EXPECT_TRUE(arr.empty());
+    arr.assign(2, 9);
+    EXPECT_EQ(arr.size(), 2u);
+    EXPECT_EQ(arr[1], 9);
+}
+
+TEST(CowPagedArrayTests, Copy_SharesPagesUntilWritten) {
+    CowPagedArray<int, 2> original;
+    original.assign(12, 0);  // 3 pages
+    CowPagedArray<int, 2> copy = original;
+    EXPECT_EQ(original.shared_page_count(), 3u);
+
+    original.mut(5) = 42;
+    EXPECT_EQ(original[5], 42);
+    EXPECT_EQ(copy[5], 0);
+    EXPECT_EQ(original.shared_page_count(), 2u);
+    EXPECT_EQ(copy.shared_page_count(), 2u);
+
+    // The page is now unique to original; writing it again copies nothing
+    original.mut(6) = 43;
+    EXPECT_EQ(original.shared_page_count(), 2u);
+
+    copy.mut(0) = 1;
+    copy.push_back(2);
+    EXPECT_EQ(original[0], 0);
+    EXPECT_EQ(original.size(), 12u);
+    EXPECT_EQ(copy.size(), 13u);
+    EXPECT_EQ(original.shared_page_count(), 1u);
+}
+
+TEST(CowPagedArrayTests, ClearThenRegrow_DoesNotWriteSharedPages) {
+    CowPagedArray<int, 2> original;
+    original.assign(8, 5);
+    CowPagedArray<int, 2> copy = original;
+    original.clear();
+    original.assign(8, 6);
+    for (size_t i = 0; i < 8; ++i) {
+        EXPECT_EQ(original[i], 6);
+        EXPECT_EQ(copy[i], 5);
+    }
+}
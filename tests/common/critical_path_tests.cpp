@@ -0,0 +1,131 @@
+/**
+ * @file critical_path_tests.cpp
+ * @brief Unit tests for analyze_critical_path()
+ */
+#include <gtest/gtest.h>
+#include <cmath>
+#include "crddagt/common/critical_path.hpp"
+#include "crddagt/common/graph_core.hpp"
+
+using namespace crddagt;
+
+TEST(CriticalPathTests, EmptyGraph)
+{
+    ExportedGraph exported;
+    auto a = analyze_critical_path(exported, {});
+    EXPECT_EQ(a->span, 0.0);
+    EXPECT_EQ(a->total_work, 0.0);
+    EXPECT_EQ(a->parallelism(), 0.0);
+    EXPECT_TRUE(a->critical_path.empty());
+}
+
+TEST(CriticalPathTests, Diamond_LongerBranchIsCritical)
+{
+    // 0 -> {1, 2} -> 3, with branch 2 the longer one
+    ExportedGraph exported;
+    exported.step_count = 4;
+    exported.combined_step_links = {{0, 1}, {0, 2}, {1, 3}, {2, 3}};
+
+    auto a = analyze_critical_path(exported, {1.0, 2.0, 5.0, 1.0});
+
+    EXPECT_EQ(a->earliest_start, (std::vector<double>{0.0, 1.0, 1.0, 6.0}));
+    EXPECT_EQ(a->latest_start, (std::vector<double>{0.0, 4.0, 1.0, 6.0}));
+    EXPECT_EQ(a->slack, (std::vector<double>{0.0, 3.0, 0.0, 0.0}));
+    EXPECT_EQ(a->critical_path, (std::vector<StepIdx>{0, 2, 3}));
+    EXPECT_EQ(a->total_work, 9.0);
+    EXPECT_EQ(a->span, 7.0);
+    EXPECT_DOUBLE_EQ(a->parallelism(), 9.0 / 7.0);
+}
+
+TEST(CriticalPathTests, IndependentSteps_SpanIsLongestStep)
+{
+    ExportedGraph exported;
+    exported.step_count = 3;
+
+    auto a = analyze_critical_path(exported, {2.0, 3.0, 3.0});
+
+    EXPECT_EQ(a->span, 3.0);
+    EXPECT_EQ(a->critical_path, (std::vector<StepIdx>{1}));
+    EXPECT_EQ(a->slack, (std::vector<double>{1.0, 0.0, 0.0}));
+}
+
+TEST(CriticalPathTests, InvalidCostsThrow)
+{
+    ExportedGraph exported;
+    exported.step_count = 2;
+    EXPECT_THROW(analyze_critical_path(exported, {1.0}), std::invalid_argument);
+    EXPECT_THROW(analyze_critical_path(exported, {1.0, -1.0}), std::invalid_argument);
+    EXPECT_THROW(analyze_critical_path(exported, {1.0, std::nan("")}), std::invalid_argument);
+}
+
+TEST(CriticalPathTests, CycleThrows)
+{
+    ExportedGraph exported;
+    exported.step_count = 2;
+    exported.combined_step_links = {{0, 1}, {1, 0}};
+    EXPECT_THROW(analyze_critical_path(exported, {1.0, 1.0}), std::invalid_argument);
+}
+
+TEST(CriticalPathTests, StaleTopologicalOrderThrows)
+{
+    ExportedGraph exported;
+    exported.step_count = 2;
+    exported.combined_step_links = {{0, 1}};
+    exported.topological_order = {1, 0};
+    EXPECT_THROW(analyze_critical_path(exported, {1.0, 1.0}), std::invalid_argument);
+}
+
+TEST(CriticalPathTests, FromGraphCore_UsesImplicitLinks)
+{
+    // Create (step 0) -> Read (steps 1, 2) -> Destroy (step 3)
+    GraphCore graph(true);
+    for (StepIdx s = 0; s < 4; ++s)
+    {
+        graph.add_step(s);
+    }
+    graph.add_field(0, 0, typeid(int), Usage::Create);
+    graph.add_field(1, 1, typeid(int), Usage::Read);
+    graph.add_field(2, 2, typeid(int), Usage::Read);
+    graph.add_field(3, 3, typeid(int), Usage::Destroy);
+    graph.link_fields(0, 1, TrustLevel::High);
+    graph.link_fields(0, 2, TrustLevel::High);
+    graph.link_fields(0, 3, TrustLevel::High);
+
+    auto exported = graph.export_graph();
+    auto a = analyze_critical_path(*exported, {1.0, 4.0, 4.0, 1.0});
+
+    EXPECT_EQ(a->span, 6.0);
+    EXPECT_EQ(a->critical_path, (std::vector<StepIdx>{0, 1, 3}));
+    EXPECT_EQ(a->slack, (std::vector<double>{0.0, 0.0, 0.0, 0.0}));
+}
+
+TEST(CriticalPathTests, PartialExport_ExcludedStepsIgnored)
+{
+    // Steps 0 -> 1 are valid; steps 2 <-> 3 form a cycle and are excluded
+    GraphCore graph(false);
+    for (StepIdx s = 0; s < 4; ++s)
+    {
+        graph.add_step(s);
+    }
+    graph.link_steps(0, 1, TrustLevel::Low);
+    graph.link_steps(2, 3, TrustLevel::Low);
+    graph.link_steps(3, 2, TrustLevel::Low);
+    auto partial = graph.export_valid_subgraph();
+    ASSERT_EQ(partial->excluded_steps, (std::vector<bool>{false, false, true, true}));
+
+    auto a = analyze_critical_path(partial->graph, {1.0, 1.0, 5.0, 5.0});
+
+    EXPECT_DOUBLE_EQ(a->total_work, 2.0);
+    EXPECT_DOUBLE_EQ(a->span, 2.0);
+    EXPECT_EQ(a->critical_path, (std::vector<StepIdx>{0, 1}));
+    EXPECT_DOUBLE_EQ(a->slack[1], 0.0);
+    EXPECT_TRUE(std::isnan(a->earliest_start[2]));
+    EXPECT_TRUE(std::isnan(a->slack[3]));
+
+    // The same result when the order has to be recomputed
+    ExportedGraph without_order = partial->graph;
+    without_order.topological_order.clear();
+    auto b = analyze_critical_path(without_order, {1.0, 1.0, 5.0, 5.0});
+    EXPECT_DOUBLE_EQ(b->total_work, 2.0);
+    EXPECT_DOUBLE_EQ(b->span, 2.0);
+}
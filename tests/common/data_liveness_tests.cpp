@@ -0,0 +1,110 @@
+/**
+ * @file data_liveness_tests.cpp
+ * @brief Unit tests for analyze_data_liveness()
+ */
+#include <gtest/gtest.h>
+#include "crddagt/common/data_liveness.hpp"
+#include "crddagt/common/graph_core.hpp"
+
+using namespace crddagt;
+
+namespace
+{
+
+/// A pipeline 0 -> 1 -> 2 -> 3 where each step creates an int read by the next,
+/// and step 0 also creates a double that step 3 destroys.
+std::shared_ptr<ExportedGraph> make_pipeline()
+{
+    GraphCore graph(true);
+    for (StepIdx s = 0; s < 4; ++s)
+    {
+        graph.add_step(s);
+    }
+    FieldIdx f = 0;
+    for (StepIdx s = 0; s < 3; ++s)
+    {
+        graph.add_field(s, f, typeid(int), Usage::Create);
+        graph.add_field(s + 1, f + 1, typeid(int), Usage::Read);
+        graph.link_fields(f, f + 1, TrustLevel::High);
+        f += 2;
+    }
+    graph.add_field(0, f, typeid(double), Usage::Create);
+    graph.add_field(3, f + 1, typeid(double), Usage::Destroy);
+    graph.link_fields(f, f + 1, TrustLevel::High);
+    return graph.export_graph();
+}
+
+} // namespace
+
+TEST(DataLivenessTests, Pipeline_IntervalsAndReleases)
+{
+    auto exported = make_pipeline();
+    ASSERT_EQ(exported->topological_order, (std::vector<StepIdx>{0, 1, 2, 3}));
+
+    auto a = analyze_data_liveness(*exported, exported->topological_order,
+                                   {{typeid(int), 4}, {typeid(double), 8}});
+
+    ASSERT_EQ(a->data.size(), 4u);
+    EXPECT_EQ(a->data[0].create_step, 0u);
+    EXPECT_EQ(a->data[0].last_use_step, 1u);
+    EXPECT_FALSE(a->data[0].is_destroyed);
+    EXPECT_EQ(a->data[3].begin_position, 0u);
+    EXPECT_EQ(a->data[3].end_position, 3u);
+    EXPECT_TRUE(a->data[3].is_destroyed);
+
+    EXPECT_EQ(a->release_offsets, (std::vector<size_t>{0, 0, 1, 2, 4}));
+    EXPECT_EQ(a->released_data, (std::vector<DataIdx>{0, 1, 2, 3}));
+
+    // Data 0..2 are the ints, data 3 the double.
+    // Live sets by position: {0, 3}, {0, 1, 3}, {1, 2, 3}, {2, 3}
+    EXPECT_EQ(a->peak_live_count, 3u);
+    EXPECT_EQ(a->peak_live_count_position, 1u);
+    EXPECT_EQ(a->peak_live_bytes, 16u);
+    ASSERT_EQ(a->per_type.size(), 2u);
+    EXPECT_EQ(a->per_type[0].ti, std::type_index(typeid(int)));
+    EXPECT_EQ(a->per_type[0].peak_live_count, 2u);
+    EXPECT_EQ(a->per_type[0].peak_live_bytes, 8u);
+    EXPECT_EQ(a->per_type[1].peak_live_count, 1u);
+    EXPECT_EQ(a->per_type[1].peak_live_bytes, 8u);
+}
+
+TEST(DataLivenessTests, LastReaderDependsOnOrder)
+{
+    // Step 0 creates, steps 1 and 2 read, with no order between the readers
+    GraphCore graph(true);
+    for (StepIdx s = 0; s < 3; ++s)
+    {
+        graph.add_step(s);
+    }
+    graph.add_field(0, 0, typeid(int), Usage::Create);
+    graph.add_field(1, 1, typeid(int), Usage::Read);
+    graph.add_field(2, 2, typeid(int), Usage::Read);
+    graph.link_fields(0, 1, TrustLevel::High);
+    graph.link_fields(0, 2, TrustLevel::High);
+    auto exported = graph.export_graph();
+
+    EXPECT_EQ(analyze_data_liveness(*exported, {0, 1, 2}, {})->data[0].last_use_step, 2u);
+    EXPECT_EQ(analyze_data_liveness(*exported, {0, 2, 1}, {})->data[0].last_use_step, 1u);
+}
+
+TEST(DataLivenessTests, UnknownTypeSizeCountsAsZeroBytes)
+{
+    auto exported = make_pipeline();
+    auto a = analyze_data_liveness(*exported, exported->topological_order);
+    EXPECT_EQ(a->peak_live_count, 3u);
+    EXPECT_EQ(a->peak_live_bytes, 0u);
+    EXPECT_EQ(a->per_type[0].object_size, 0u);
+}
+
+TEST(DataLivenessTests, InvalidOrdersThrow)
+{
+    auto exported = make_pipeline();
+    EXPECT_THROW(analyze_data_liveness(*exported, std::vector<StepIdx>{0, 1, 1, 3}),
+                 std::invalid_argument);
+    EXPECT_THROW(analyze_data_liveness(*exported, std::vector<StepIdx>{0, 1, 2}),
+                 std::invalid_argument);
+    EXPECT_THROW(analyze_data_liveness(*exported, std::vector<StepIdx>{1, 0, 2, 3}),
+                 std::invalid_argument);
+    EXPECT_THROW(analyze_data_liveness(*exported, std::vector<StepIdx>{0, 1, 2, 7}),
+                 std::out_of_range);
+}
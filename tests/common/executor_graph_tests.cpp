@@ -0,0 +1,144 @@
+/**
+ * @file executor_graph_tests.cpp
+ * @brief Unit tests for make_executor_graph()
+ */
+#include <gtest/gtest.h>
+#include "crddagt/common/executor_graph.hpp"
+#include "crddagt/common/graph_core.hpp"
+
+using namespace crddagt;
+
+TEST(ExecutorGraphTests, EmptyGraph)
+{
+    ExportedGraph exported;
+    auto g = make_executor_graph(exported);
+    EXPECT_EQ(g->step_count, 0u);
+    EXPECT_EQ(g->runnable_step_count, 0u);
+    EXPECT_EQ(g->successor_offsets, (std::vector<size_t>{0}));
+    EXPECT_EQ(g->predecessor_offsets, (std::vector<size_t>{0}));
+    EXPECT_TRUE(g->source_steps.empty());
+}
+
+TEST(ExecutorGraphTests, DeduplicatesAndSortsRows)
+{
+    ExportedGraph exported;
+    exported.step_count = 4;
+    exported.combined_step_links = {{0, 2}, {0, 1}, {0, 2}, {1, 3}, {2, 3}, {0, 1}};
+
+    auto g = make_executor_graph(exported);
+
+    EXPECT_EQ(g->successor_offsets, (std::vector<size_t>{0, 2, 3, 4, 4}));
+    EXPECT_EQ(g->successors, (std::vector<StepIdx>{1, 2, 3, 3}));
+    EXPECT_EQ(g->predecessor_offsets, (std::vector<size_t>{0, 0, 1, 2, 4}));
+    EXPECT_EQ(g->predecessors, (std::vector<StepIdx>{0, 0, 1, 2}));
+    EXPECT_EQ(g->initial_predecessor_counts, (std::vector<size_t>{0, 1, 1, 2}));
+    EXPECT_EQ(g->source_steps, (std::vector<StepIdx>{0}));
+}
+
+TEST(ExecutorGraphTests, UnlinkedStepsAreSources)
+{
+    ExportedGraph exported;
+    exported.step_count = 3;
+    exported.combined_step_links = {{2, 0}};
+
+    auto g = make_executor_graph(exported);
+
+    EXPECT_EQ(g->source_steps, (std::vector<StepIdx>{1, 2}));
+    EXPECT_EQ(g->initial_predecessor_counts, (std::vector<size_t>{1, 0, 0}));
+}
+
+TEST(ExecutorGraphTests, OutOfRangeThrows)
+{
+    ExportedGraph exported;
+    exported.step_count = 2;
+    exported.combined_step_links = {{0, 5}};
+    EXPECT_THROW(make_executor_graph(exported), std::out_of_range);
+}
+
+TEST(ExecutorGraphTests, DependencyCountingRunsEveryStepInOrder)
+{
+    GraphCore graph(true);
+    for (StepIdx s = 0; s < 5; ++s)
+    {
+        graph.add_step(s);
+    }
+    graph.add_field(0, 0, typeid(int), Usage::Create);
+    graph.add_field(1, 1, typeid(int), Usage::Read);
+    graph.add_field(2, 2, typeid(int), Usage::Read);
+    graph.add_field(3, 3, typeid(int), Usage::Destroy);
+    graph.link_fields(0, 1, TrustLevel::High);
+    graph.link_fields(0, 2, TrustLevel::High);
+    graph.link_fields(0, 3, TrustLevel::High);
+    graph.link_steps(0, 1, TrustLevel::High); // duplicate of an implicit link
+    graph.link_steps(3, 4, TrustLevel::High);
+
+    auto exported = graph.export_graph();
+    auto g = make_executor_graph(*exported);
+
+    std::vector<size_t> remaining = g->initial_predecessor_counts;
+    std::vector<StepIdx> ready = g->source_steps;
+    std::vector<size_t> finish_time(g->step_count, 0);
+    size_t time = 0;
+    while (!ready.empty())
+    {
+        StepIdx s = ready.back();
+        ready.pop_back();
+        finish_time[s] = ++time;
+        for (size_t i = g->successor_offsets[s]; i < g->successor_offsets[s + 1]; ++i)
+        {
+            if (--remaining[g->successors[i]] == 0)
+            {
+                ready.push_back(g->successors[i]);
+            }
+        }
+    }
+
+    EXPECT_EQ(g->runnable_step_count, g->step_count);
+    EXPECT_EQ(time, g->runnable_step_count);
+    for (const auto& [before, after] : exported->combined_step_links)
+    {
+        EXPECT_LT(finish_time[before], finish_time[after]);
+    }
+}
+
+TEST(ExecutorGraphTests, PartialExport_ExcludedStepsAreNotSources)
+{
+    // Steps 0 -> 1 are valid; steps 2 <-> 3 form a cycle and are excluded
+    GraphCore graph(false);
+    for (StepIdx s = 0; s < 4; ++s)
+    {
+        graph.add_step(s);
+    }
+    graph.link_steps(0, 1, TrustLevel::Low);
+    graph.link_steps(2, 3, TrustLevel::Low);
+    graph.link_steps(3, 2, TrustLevel::Low);
+    auto partial = graph.export_valid_subgraph();
+    ASSERT_EQ(partial->excluded_steps, (std::vector<bool>{false, false, true, true}));
+
+    auto g = make_executor_graph(partial->graph);
+
+    EXPECT_EQ(g->step_count, 4u);
+    EXPECT_EQ(g->runnable_step_count, 2u);
+    EXPECT_EQ(g->source_steps, (std::vector<StepIdx>{0}));
+    EXPECT_EQ(g->initial_predecessor_counts, (std::vector<size_t>{0, 1, 0, 0}));
+
+    // A dependency-counting run finishes exactly the runnable steps
+    std::vector<size_t> remaining = g->initial_predecessor_counts;
+    std::vector<StepIdx> ready = g->source_steps;
+    std::vector<StepIdx> finished;
+    while (!ready.empty())
+    {
+        StepIdx s = ready.back();
+        ready.pop_back();
+        finished.push_back(s);
+        for (size_t i = g->successor_offsets[s]; i < g->successor_offsets[s + 1]; ++i)
+        {
+            if (--remaining[g->successors[i]] == 0)
+            {
+                ready.push_back(g->successors[i]);
+            }
+        }
+    }
+    EXPECT_EQ(finished.size(), g->runnable_step_count);
+    EXPECT_EQ(finished, (std::vector<StepIdx>{0, 1}));
+}
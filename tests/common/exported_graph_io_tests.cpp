@@ -0,0 +1,160 @@
+/**
+ * @file exported_graph_io_tests.cpp
+ * @brief Unit tests for the exported graph binary format and MappedExportedGraph
+ */
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include "crddagt/common/exported_graph_io.hpp"
+#include "crddagt/common/graph_core.hpp"
+
+using namespace crddagt;
+
+namespace
+{
+
+/// A file path under the system temp directory, removed on destruction.
+class TempPath
+{
+public:
+    explicit TempPath(const std::string& name)
+        : m_path((std::filesystem::temp_directory_path() / name).string())
+    {
+    }
+    ~TempPath() { std::remove(m_path.c_str()); }
+    const std::string& str() const { return m_path; }
+
+private:
+    std::string m_path;
+};
+
+std::shared_ptr<ExportedGraph> make_sample_graph()
+{
+    GraphCore graph(true);
+    for (StepIdx s = 0; s < 4; ++s)
+    {
+        graph.add_step(s);
+    }
+    graph.add_field(0, 0, typeid(int), Usage::Create);
+    graph.add_field(1, 1, typeid(int), Usage::Read);
+    graph.add_field(3, 2, typeid(int), Usage::Destroy);
+    graph.add_field(1, 3, typeid(std::string), Usage::Create);
+    graph.add_field(2, 4, typeid(std::string), Usage::Read);
+    graph.link_fields(0, 1, TrustLevel::High);
+    graph.link_fields(0, 2, TrustLevel::High);
+    graph.link_fields(3, 4, TrustLevel::High);
+    graph.link_steps(2, 3, TrustLevel::High);
+    return graph.export_graph();
+}
+
+} // namespace
+
+TEST(ExportedGraphIoTests, RoundTrip_MaterializeEqualsOriginal)
+{
+    auto original = make_sample_graph();
+    TempPath path("crddagt_io_roundtrip.bin");
+    save_exported_graph(*original, path.str());
+
+    auto mapped = MappedExportedGraph::open(path.str());
+    auto copy = mapped->materialize({typeid(int), typeid(std::string)});
+
+    EXPECT_EQ(copy->step_count, original->step_count);
+    EXPECT_EQ(copy->field_data_pairs, original->field_data_pairs);
+    EXPECT_EQ(copy->implicit_step_links, original->implicit_step_links);
+    EXPECT_EQ(copy->explicit_step_links, original->explicit_step_links);
+    EXPECT_EQ(copy->combined_step_links, original->combined_step_links);
+    EXPECT_EQ(copy->topological_order, original->topological_order);
+    EXPECT_EQ(copy->step_levels, original->step_levels);
+    EXPECT_EQ(copy->level_offsets, original->level_offsets);
+    EXPECT_EQ(copy->level_steps, original->level_steps);
+    ASSERT_EQ(copy->data_infos.size(), original->data_infos.size());
+    for (size_t i = 0; i < copy->data_infos.size(); ++i)
+    {
+        EXPECT_EQ(copy->data_infos[i].didx, original->data_infos[i].didx);
+        EXPECT_EQ(copy->data_infos[i].ti, original->data_infos[i].ti);
+        EXPECT_EQ(copy->data_infos[i].field_usages, original->data_infos[i].field_usages);
+    }
+}
+
+TEST(ExportedGraphIoTests, Views_ExposeSectionsInPlace)
+{
+    auto original = make_sample_graph();
+    TempPath path("crddagt_io_views.bin");
+    save_exported_graph(*original, path.str());
+
+    auto mapped = MappedExportedGraph::open(path.str());
+
+    EXPECT_EQ(mapped->step_count(), 4u);
+    ASSERT_EQ(mapped->data_infos().size(), 2u);
+    const auto& info = mapped->data_infos()[1];
+    EXPECT_EQ(mapped->type_name(info), typeid(std::string).name());
+    ASSERT_EQ(mapped->field_usages(info).size(), 2u);
+    EXPECT_EQ(mapped->field_usages(info)[0].field, 3u);
+
+    // CSR successors agree with the combined links
+    ASSERT_EQ(mapped->successor_offsets().size(), 5u);
+    EXPECT_EQ(mapped->successors().size(), original->combined_step_links.size());
+    for (const auto& [before, after] : original->combined_step_links)
+    {
+        auto first = mapped->successors().begin() + mapped->successor_offsets()[before];
+        auto last = mapped->successors().begin() + mapped->successor_offsets()[before + 1];
+        EXPECT_NE(std::find(first, last, after), last);
+    }
+}
+
+TEST(ExportedGraphIoTests, PartialExport_ExcludedLevelSurvives)
+{
+    GraphCore graph(false);
+    graph.add_step(0);
+    graph.add_step(1);
+    graph.add_step(2);
+    graph.link_steps(0, 1, TrustLevel::Low);
+    graph.link_steps(1, 0, TrustLevel::Low);
+    auto partial = graph.export_valid_subgraph();
+
+    TempPath path("crddagt_io_partial.bin");
+    save_exported_graph(partial->graph, path.str());
+    auto copy = MappedExportedGraph::open(path.str())->materialize({});
+
+    EXPECT_EQ(copy->step_levels, partial->graph.step_levels);
+    EXPECT_EQ(copy->step_levels[0], excluded_step_level);
+}
+
+TEST(ExportedGraphIoTests, UnknownTypeThrowsOnMaterialize)
+{
+    auto original = make_sample_graph();
+    TempPath path("crddagt_io_unknown_type.bin");
+    save_exported_graph(*original, path.str());
+
+    auto mapped = MappedExportedGraph::open(path.str());
+    EXPECT_THROW(mapped->materialize({typeid(int)}), std::runtime_error);
+}
+
+TEST(ExportedGraphIoTests, MalformedFilesAreRejected)
+{
+    TempPath path("crddagt_io_malformed.bin");
+    EXPECT_THROW(MappedExportedGraph::open(path.str()), std::runtime_error); // missing
+
+    {
+        std::ofstream out(path.str(), std::ios::binary);
+        out << "not a graph file, but long enough to hold a header";
+    }
+    EXPECT_THROW(MappedExportedGraph::open(path.str()), std::runtime_error);
+
+    // A valid file truncated in the middle of its sections
+    auto original = make_sample_graph();
+    std::string bytes;
+    {
+        std::ostringstream buffer;
+        write_exported_graph(*original, buffer);
+        bytes = buffer.str();
+    }
+    {
+        std::ofstream out(path.str(), std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size() / 2));
+    }
+    EXPECT_THROW(MappedExportedGraph::open(path.str()), std::runtime_error);
+}
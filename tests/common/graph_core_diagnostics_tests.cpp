@@ -1179,3 +1179,116 @@ TEST(GraphCoreDiagnosticsTests, EdgeCase_MultipleIndependentDataFlows)
     }
     EXPECT_FALSE(found_usage_error);
 }
+
+// ============================================================================
+// Eager Cycle Path Tests
+// ============================================================================
+
+TEST(GraphCoreDiagnosticsTests, CyclePath_ExplicitLinks_Eager)
+{
+    GraphCore graph(true);
+    for (StepIdx s = 0; s < 4; ++s)
+    {
+        graph.add_step(s);
+    }
+    graph.link_steps(0, 1, TrustLevel::High); // link 0
+    graph.link_steps(1, 2, TrustLevel::High); // link 1
+    graph.link_steps(0, 3, TrustLevel::High); // link 2 (not on the path)
+
+    try
+    {
+        graph.link_steps(2, 0, TrustLevel::Low);
+        FAIL() << "Expected GraphCoreError";
+    }
+    catch (const GraphCoreError& e)
+    {
+        EXPECT_EQ(e.code(), GraphCoreErrorCode::CycleDetected);
+        EXPECT_EQ(e.cycle_steps(), (std::vector<StepIdx>{0, 1, 2}));
+        ASSERT_EQ(e.cycle_links().size(), 2u);
+        EXPECT_TRUE(e.cycle_links()[0].is_explicit);
+        EXPECT_EQ(e.cycle_links()[0].link_index, 0u);
+        EXPECT_EQ(e.cycle_links()[0].before, 0u);
+        EXPECT_EQ(e.cycle_links()[0].after, 1u);
+        EXPECT_TRUE(e.cycle_links()[1].is_explicit);
+        EXPECT_EQ(e.cycle_links()[1].link_index, 1u);
+    }
+}
+
+TEST(GraphCoreDiagnosticsTests, CyclePath_MixedExplicitAndImplicit_Eager)
+{
+    // Step 0 creates data read by step 1 (implicit 0 -> 1), explicit 1 -> 2,
+    // then an explicit 2 -> 0 closes the cycle.
+    GraphCore graph(true);
+    graph.add_step(0);
+    graph.add_step(1);
+    graph.add_step(2);
+    graph.add_field(0, 0, typeid(int), Usage::Create);
+    graph.add_field(1, 1, typeid(int), Usage::Read);
+    graph.link_fields(1, 0, TrustLevel::Middle); // field link 0
+    graph.link_steps(1, 2, TrustLevel::High);    // step link 0
+
+    try
+    {
+        graph.link_steps(2, 0, TrustLevel::Low);
+        FAIL() << "Expected GraphCoreError";
+    }
+    catch (const GraphCoreError& e)
+    {
+        EXPECT_EQ(e.code(), GraphCoreErrorCode::CycleDetected);
+        EXPECT_EQ(e.cycle_steps(), (std::vector<StepIdx>{0, 1, 2}));
+        ASSERT_EQ(e.cycle_links().size(), 2u);
+
+        const CycleLink& implicit = e.cycle_links()[0];
+        EXPECT_FALSE(implicit.is_explicit);
+        EXPECT_EQ(implicit.link_index, 0u);
+        EXPECT_EQ(implicit.before_field, 0u);
+        EXPECT_EQ(implicit.after_field, 1u);
+
+        const CycleLink& explicit_link = e.cycle_links()[1];
+        EXPECT_TRUE(explicit_link.is_explicit);
+        EXPECT_EQ(explicit_link.link_index, 0u);
+    }
+}
+
+TEST(GraphCoreDiagnosticsTests, CyclePath_RejectedFieldLink_Eager)
+{
+    // Explicit 1 -> 0, then linking a Create on step 0 with a Read on step 1
+    // would add the implicit edge 0 -> 1.
+    GraphCore graph(true);
+    graph.add_step(0);
+    graph.add_step(1);
+    graph.add_field(0, 0, typeid(int), Usage::Create);
+    graph.add_field(1, 1, typeid(int), Usage::Read);
+    graph.link_steps(1, 0, TrustLevel::High);
+
+    try
+    {
+        graph.link_fields(0, 1, TrustLevel::Low);
+        FAIL() << "Expected GraphCoreError";
+    }
+    catch (const GraphCoreError& e)
+    {
+        EXPECT_EQ(e.code(), GraphCoreErrorCode::CycleDetected);
+        EXPECT_EQ(e.cycle_steps(), (std::vector<StepIdx>{1, 0}));
+        ASSERT_EQ(e.cycle_links().size(), 1u);
+        EXPECT_TRUE(e.cycle_links()[0].is_explicit);
+    }
+
+    // The rejected link left no edge behind
+    EXPECT_NO_THROW(graph.link_steps(1, 0, TrustLevel::High));
+}
+
+TEST(GraphCoreDiagnosticsTests, CyclePath_OtherErrorsHaveNoPath)
+{
+    GraphCore graph(true);
+    try
+    {
+        graph.add_step(1);
+        FAIL() << "Expected GraphCoreError";
+    }
+    catch (const GraphCoreError& e)
+    {
+        EXPECT_TRUE(e.cycle_steps().empty());
+        EXPECT_TRUE(e.cycle_links().empty());
+    }
+}
@@ -0,0 +1,785 @@
+/**
+ * @file graph_core_export_tests.cpp
+ * @brief Unit tests for GraphCore::export_graph() and related export modes
+ */
+#include <gtest/gtest.h>
+#include <algorithm>
+#include "crddagt/common/graph_core.hpp"
+
+using namespace crddagt;
+
+// ============================================================================
+// Data Object Assignment Tests
+// ============================================================================
+
+TEST(GraphCoreExportTests, DataIdx_AssignedInOrderOfLowestField)
+{
+    GraphCore graph(true);
+    graph.add_step(0);
+    graph.add_step(1);
+    graph.add_field(0, 0, typeid(int), Usage::Create);   // data A
+    graph.add_field(0, 1, typeid(float), Usage::Create); // data B
+    graph.add_field(1, 2, typeid(float), Usage::Read);   // data B
+    graph.add_field(1, 3, typeid(int), Usage::Read);     // data A
+
+    // Link B first so that union-find roots do not follow field order
+    graph.link_fields(2, 1, TrustLevel::High);
+    graph.link_fields(3, 0, TrustLevel::High);
+
+    auto exported = graph.export_graph();
+
+    ASSERT_EQ(exported->field_data_pairs.size(), 4u);
+    EXPECT_EQ(exported->field_data_pairs[0], FieldDataPair(0, 0));
+    EXPECT_EQ(exported->field_data_pairs[1], FieldDataPair(1, 1));
+    EXPECT_EQ(exported->field_data_pairs[2], FieldDataPair(2, 1));
+    EXPECT_EQ(exported->field_data_pairs[3], FieldDataPair(3, 0));
+
+    ASSERT_EQ(exported->data_infos.size(), 2u);
+    EXPECT_EQ(exported->data_infos[0].didx, 0u);
+    EXPECT_EQ(exported->data_infos[0].ti, std::type_index(typeid(int)));
+    EXPECT_EQ(exported->data_infos[1].didx, 1u);
+    EXPECT_EQ(exported->data_infos[1].ti, std::type_index(typeid(float)));
+}
+
+TEST(GraphCoreExportTests, DataInfo_FieldUsagesInFieldOrder)
+{
+    GraphCore graph(true);
+    for (StepIdx s = 0; s < 4; ++s)
+    {
+        graph.add_step(s);
+    }
+    graph.add_field(3, 0, typeid(int), Usage::Destroy);
+    graph.add_field(2, 1, typeid(int), Usage::Read);
+    graph.add_field(0, 2, typeid(int), Usage::Create);
+    graph.add_field(1, 3, typeid(int), Usage::Read);
+
+    graph.link_fields(3, 2, TrustLevel::High);
+    graph.link_fields(0, 1, TrustLevel::High);
+    graph.link_fields(1, 2, TrustLevel::High);
+
+    auto exported = graph.export_graph();
+
+    ASSERT_EQ(exported->data_infos.size(), 1u);
+    const auto& usages = exported->data_infos[0].field_usages;
+    ASSERT_EQ(usages.size(), 4u);
+    EXPECT_EQ(usages[0], std::make_tuple(StepIdx{3}, FieldIdx{0}, Usage::Destroy));
+    EXPECT_EQ(usages[1], std::make_tuple(StepIdx{2}, FieldIdx{1}, Usage::Read));
+    EXPECT_EQ(usages[2], std::make_tuple(StepIdx{0}, FieldIdx{2}, Usage::Create));
+    EXPECT_EQ(usages[3], std::make_tuple(StepIdx{1}, FieldIdx{3}, Usage::Read));
+}
+
+TEST(GraphCoreExportTests, ImplicitLinks_FollowUsageOrder)
+{
+    GraphCore graph(true);
+    graph.add_step(0);
+    graph.add_step(1);
+    graph.add_step(2);
+    graph.add_field(0, 0, typeid(int), Usage::Create);
+    graph.add_field(1, 1, typeid(int), Usage::Read);
+    graph.add_field(2, 2, typeid(int), Usage::Destroy);
+    graph.link_fields(0, 1, TrustLevel::High);
+    graph.link_fields(1, 2, TrustLevel::High);
+
+    auto exported = graph.export_graph();
+
+    std::vector<StepLinkPair> implicit = exported->implicit_step_links;
+    std::sort(implicit.begin(), implicit.end());
+    std::vector<StepLinkPair> expected{{0, 1}, {0, 2}, {1, 2}};
+    EXPECT_EQ(implicit, expected);
+    EXPECT_TRUE(exported->explicit_step_links.empty());
+    EXPECT_EQ(exported->combined_step_links.size(), 3u);
+}
+
+TEST(GraphCoreExportTests, Diagnostics_DeterministicAcrossRuns)
+{
+    // Two independent double-Create classes; error order follows class order
+    GraphCore graph(false);
+    graph.add_step(0);
+    graph.add_step(1);
+    graph.add_field(0, 0, typeid(int), Usage::Create);
+    graph.add_field(1, 1, typeid(int), Usage::Create);
+    graph.add_field(0, 2, typeid(float), Usage::Create);
+    graph.add_field(1, 3, typeid(float), Usage::Create);
+    graph.link_fields(3, 2, TrustLevel::Middle);
+    graph.link_fields(1, 0, TrustLevel::Middle);
+
+    auto diagnostics = graph.get_diagnostics();
+    ASSERT_EQ(diagnostics->errors().size(), 2u);
+    EXPECT_EQ(diagnostics->errors()[0].involved_fields, (std::vector<FieldIdx>{0, 1}));
+    EXPECT_EQ(diagnostics->errors()[1].involved_fields, (std::vector<FieldIdx>{2, 3}));
+}
+
+TEST(GraphCoreExportTests, InvalidGraph_Throws)
+{
+    GraphCore graph(false);
+    graph.add_step(0);
+    graph.add_step(1);
+    graph.add_field(0, 0, typeid(int), Usage::Create);
+    graph.add_field(1, 1, typeid(int), Usage::Create);
+    graph.link_fields(0, 1, TrustLevel::Middle);
+
+    EXPECT_THROW(graph.export_graph(), GraphCoreError);
+}
+
+// ============================================================================
+// Valid Subgraph Export Tests
+// ============================================================================
+
+TEST(GraphCoreExportTests, ValidSubgraph_ValidGraph_NothingExcluded)
+{
+    GraphCore graph(true);
+    graph.add_step(0);
+    graph.add_step(1);
+    graph.add_field(0, 0, typeid(int), Usage::Create);
+    graph.add_field(1, 1, typeid(int), Usage::Read);
+    graph.link_fields(0, 1, TrustLevel::High);
+
+    auto full = graph.export_graph();
+    auto partial = graph.export_valid_subgraph();
+
+    EXPECT_EQ(partial->excluded_steps, (std::vector<bool>{false, false}));
+    EXPECT_EQ(partial->excluded_fields, (std::vector<bool>{false, false}));
+    EXPECT_EQ(partial->graph.field_data_pairs, full->field_data_pairs);
+    EXPECT_EQ(partial->graph.combined_step_links, full->combined_step_links);
+    EXPECT_EQ(partial->graph.data_infos.size(), full->data_infos.size());
+}
+
+TEST(GraphCoreExportTests, ValidSubgraph_CycleExcludesDownstreamOnly)
+{
+    // Steps 0 <-> 1 form a cycle, step 2 runs after step 1.
+    // Steps 3 -> 4 are an independent valid data flow.
+    GraphCore graph(false);
+    for (StepIdx s = 0; s < 5; ++s)
+    {
+        graph.add_step(s);
+    }
+    graph.link_steps(0, 1, TrustLevel::Low);
+    graph.link_steps(1, 0, TrustLevel::Low);
+    graph.link_steps(1, 2, TrustLevel::High);
+    graph.add_field(3, 0, typeid(int), Usage::Create);
+    graph.add_field(4, 1, typeid(int), Usage::Read);
+    graph.link_fields(0, 1, TrustLevel::High);
+
+    auto partial = graph.export_valid_subgraph();
+
+    EXPECT_EQ(partial->excluded_steps, (std::vector<bool>{true, true, true, false, false}));
+    EXPECT_EQ(partial->excluded_fields, (std::vector<bool>{false, false}));
+    EXPECT_TRUE(partial->graph.explicit_step_links.empty());
+    EXPECT_EQ(partial->graph.combined_step_links, (std::vector<StepLinkPair>{{3, 4}}));
+    ASSERT_EQ(partial->graph.data_infos.size(), 1u);
+}
+
+TEST(GraphCoreExportTests, ValidSubgraph_MissingCreateExcludesReaderAndDestroyer)
+{
+    // Data A: read by step 0, destroyed by step 1, never created.
+    // Data B: created by step 2, read by step 3.
+    GraphCore graph(false);
+    for (StepIdx s = 0; s < 4; ++s)
+    {
+        graph.add_step(s);
+    }
+    graph.add_field(0, 0, typeid(int), Usage::Read);
+    graph.add_field(1, 1, typeid(int), Usage::Destroy);
+    graph.add_field(2, 2, typeid(float), Usage::Create);
+    graph.add_field(3, 3, typeid(float), Usage::Read);
+    graph.link_fields(0, 1, TrustLevel::Middle);
+    graph.link_fields(2, 3, TrustLevel::Middle);
+
+    EXPECT_THROW(graph.export_graph(), GraphCoreError);
+    auto partial = graph.export_valid_subgraph();
+
+    EXPECT_EQ(partial->excluded_steps, (std::vector<bool>{true, true, false, false}));
+    EXPECT_EQ(partial->excluded_fields, (std::vector<bool>{true, true, false, false}));
+    ASSERT_EQ(partial->graph.field_data_pairs.size(), 2u);
+    EXPECT_EQ(partial->graph.field_data_pairs[0], FieldDataPair(2, 0));
+    EXPECT_EQ(partial->graph.field_data_pairs[1], FieldDataPair(3, 0));
+    ASSERT_EQ(partial->graph.data_infos.size(), 1u);
+    EXPECT_EQ(partial->graph.data_infos[0].ti, std::type_index(typeid(float)));
+}
+
+TEST(GraphCoreExportTests, ValidSubgraph_UpstreamOfErrorIsRetained)
+{
+    // Step 0 creates data read by steps 1 and 2, step 1 and 2 both create
+    // another data object (MultipleCreate) which step 3 reads.
+    GraphCore graph(false);
+    for (StepIdx s = 0; s < 4; ++s)
+    {
+        graph.add_step(s);
+    }
+    graph.add_field(0, 0, typeid(int), Usage::Create);
+    graph.add_field(1, 1, typeid(int), Usage::Read);
+    graph.add_field(2, 2, typeid(int), Usage::Read);
+    graph.add_field(1, 3, typeid(float), Usage::Create);
+    graph.add_field(2, 4, typeid(float), Usage::Create);
+    graph.add_field(3, 5, typeid(float), Usage::Read);
+    graph.link_fields(0, 1, TrustLevel::High);
+    graph.link_fields(0, 2, TrustLevel::High);
+    graph.link_fields(3, 4, TrustLevel::Low);
+    graph.link_fields(3, 5, TrustLevel::Low);
+
+    auto partial = graph.export_valid_subgraph();
+
+    EXPECT_EQ(partial->excluded_steps, (std::vector<bool>{false, true, true, true}));
+    ASSERT_EQ(partial->graph.field_data_pairs.size(), 1u);
+    EXPECT_EQ(partial->graph.field_data_pairs[0], FieldDataPair(0, 0));
+    ASSERT_EQ(partial->graph.data_infos.size(), 1u);
+    EXPECT_EQ(partial->graph.data_infos[0].field_usages.size(), 1u);
+    EXPECT_TRUE(partial->graph.combined_step_links.empty());
+}
+
+// ============================================================================
+// Export Options Tests
+// ============================================================================
+
+TEST(GraphCoreExportTests, Options_ReduceCombinedStepLinks)
+{
+    // Create on step 0, Reads on step 1, Destroy on step 2, plus explicit 0 -> 1.
+    // Combined: 0->1 (explicit), 0->1, 0->2, 1->2 (implicit). Reduced: 0->1, 1->2.
+    GraphCore graph(true);
+    graph.add_step(0);
+    graph.add_step(1);
+    graph.add_step(2);
+    graph.add_field(0, 0, typeid(int), Usage::Create);
+    graph.add_field(1, 1, typeid(int), Usage::Read);
+    graph.add_field(2, 2, typeid(int), Usage::Destroy);
+    graph.link_steps(0, 1, TrustLevel::High);
+    graph.link_fields(0, 1, TrustLevel::High);
+    graph.link_fields(0, 2, TrustLevel::High);
+
+    ExportOptions options;
+    options.reduce_combined_step_links = true;
+    auto exported = graph.export_graph(options);
+
+    EXPECT_EQ(exported->step_count, 3u);
+    EXPECT_EQ(exported->combined_step_links, (std::vector<StepLinkPair>{{0, 1}, {1, 2}}));
+    EXPECT_EQ(exported->eliminated_step_link_count, 2u);
+    EXPECT_EQ(exported->explicit_step_links.size(), 1u);
+    EXPECT_EQ(exported->implicit_step_links.size(), 3u);
+
+    auto unreduced = graph.export_graph();
+    EXPECT_EQ(unreduced->combined_step_links.size(), 4u);
+    EXPECT_EQ(unreduced->eliminated_step_link_count, 0u);
+}
+
+// ============================================================================
+// Topological Order and Level Tests
+// ============================================================================
+
+TEST(GraphCoreExportTests, Levels_FollowExplicitAndImplicitLinks)
+{
+    // Step 0 creates data read by steps 1 and 2; step 3 runs after step 2.
+    GraphCore graph(true);
+    for (StepIdx s = 0; s < 4; ++s)
+    {
+        graph.add_step(s);
+    }
+    graph.add_field(0, 0, typeid(int), Usage::Create);
+    graph.add_field(1, 1, typeid(int), Usage::Read);
+    graph.add_field(2, 2, typeid(int), Usage::Read);
+    graph.link_fields(0, 1, TrustLevel::High);
+    graph.link_fields(0, 2, TrustLevel::High);
+    graph.link_steps(2, 3, TrustLevel::High);
+
+    auto exported = graph.export_graph();
+
+    EXPECT_EQ(exported->topological_order, (std::vector<StepIdx>{0, 1, 2, 3}));
+    EXPECT_EQ(exported->step_levels, (std::vector<size_t>{0, 1, 1, 2}));
+    EXPECT_EQ(exported->level_offsets, (std::vector<size_t>{0, 1, 3, 4}));
+    EXPECT_EQ(exported->level_steps, (std::vector<StepIdx>{0, 1, 2, 3}));
+}
+
+TEST(GraphCoreExportTests, Levels_ValidSubgraphLeavesOutExcludedSteps)
+{
+    GraphCore graph(false);
+    for (StepIdx s = 0; s < 5; ++s)
+    {
+        graph.add_step(s);
+    }
+    graph.link_steps(0, 1, TrustLevel::Low);
+    graph.link_steps(1, 0, TrustLevel::Low);
+    graph.link_steps(1, 2, TrustLevel::High);
+    graph.add_field(3, 0, typeid(int), Usage::Create);
+    graph.add_field(4, 1, typeid(int), Usage::Read);
+    graph.link_fields(0, 1, TrustLevel::High);
+
+    auto partial = graph.export_valid_subgraph();
+    const ExportedGraph& g = partial->graph;
+
+    EXPECT_EQ(g.topological_order, (std::vector<StepIdx>{3, 4}));
+    EXPECT_EQ(g.step_levels, (std::vector<size_t>{excluded_step_level, excluded_step_level,
+                                                  excluded_step_level, 0, 1}));
+    EXPECT_EQ(g.level_offsets, (std::vector<size_t>{0, 1, 2}));
+    EXPECT_EQ(g.level_steps, (std::vector<StepIdx>{3, 4}));
+}
+
+// ============================================================================
+// Structural Hash Tests
+// ============================================================================
+
+namespace
+{
+
+/// Steps 0..2; data A created by 0, read by 1 and 2; step 1 before step 2.
+void build_hash_sample(GraphCore& graph, bool reverse_link_order)
+{
+    for (StepIdx s = 0; s < 3; ++s)
+    {
+        graph.add_step(s);
+    }
+    graph.add_field(0, 0, typeid(int), Usage::Create);
+    graph.add_field(1, 1, typeid(int), Usage::Read);
+    graph.add_field(2, 2, typeid(int), Usage::Read);
+    if (reverse_link_order)
+    {
+        graph.link_fields(2, 1, TrustLevel::Low);
+        graph.link_fields(1, 0, TrustLevel::Low);
+        graph.link_fields(0, 2, TrustLevel::Low); // redundant
+    }
+    else
+    {
+        graph.link_fields(0, 1, TrustLevel::High);
+        graph.link_fields(0, 2, TrustLevel::High);
+    }
+    graph.link_steps(1, 2, TrustLevel::High);
+}
+
+} // namespace
+
+TEST(GraphCoreExportTests, StructuralHash_IndependentOfLinkOrderAndTrust)
+{
+    GraphCore a(true);
+    GraphCore b(false);
+    build_hash_sample(a, false);
+    build_hash_sample(b, true);
+    EXPECT_EQ(a.structural_hash(), b.structural_hash());
+}
+
+TEST(GraphCoreExportTests, StructuralHash_ChangesWithStructure)
+{
+    GraphCore base(true);
+    build_hash_sample(base, false);
+    const uint64_t h = base.structural_hash();
+
+    GraphCore extra_step(true);
+    build_hash_sample(extra_step, false);
+    extra_step.add_step(3);
+    EXPECT_NE(extra_step.structural_hash(), h);
+
+    GraphCore extra_link(true);
+    build_hash_sample(extra_link, false);
+    extra_link.link_steps(0, 2, TrustLevel::High);
+    EXPECT_NE(extra_link.structural_hash(), h);
+
+    // Same fields, different partition: field 2 left unlinked
+    GraphCore other_partition(true);
+    for (StepIdx s = 0; s < 3; ++s)
+    {
+        other_partition.add_step(s);
+    }
+    other_partition.add_field(0, 0, typeid(int), Usage::Create);
+    other_partition.add_field(1, 1, typeid(int), Usage::Read);
+    other_partition.add_field(2, 2, typeid(int), Usage::Read);
+    other_partition.link_fields(0, 1, TrustLevel::High);
+    other_partition.link_steps(1, 2, TrustLevel::High);
+    EXPECT_NE(other_partition.structural_hash(), h);
+
+    // Same shape, different field type
+    GraphCore other_type(true);
+    for (StepIdx s = 0; s < 3; ++s)
+    {
+        other_type.add_step(s);
+    }
+    other_type.add_field(0, 0, typeid(float), Usage::Create);
+    other_type.add_field(1, 1, typeid(float), Usage::Read);
+    other_type.add_field(2, 2, typeid(float), Usage::Read);
+    other_type.link_fields(0, 1, TrustLevel::High);
+    other_type.link_fields(0, 2, TrustLevel::High);
+    other_type.link_steps(1, 2, TrustLevel::High);
+    EXPECT_NE(other_type.structural_hash(), h);
+}
+
+TEST(GraphCoreExportTests, StructuralHash_EqualPartitionsFromDifferentMerges)
+{
+    // {0, 1} + {2, 3} versus {0, 2} + {1, 3}, both merged into one class
+    auto build = [](GraphCore& graph, FieldIdx x, FieldIdx y)
+    {
+        graph.add_step(0);
+        for (FieldIdx f = 0; f < 4; ++f)
+        {
+            graph.add_field(0, f, typeid(int), Usage::Read);
+        }
+        graph.link_fields(0, x, TrustLevel::High);
+        graph.link_fields(y, 3, TrustLevel::High);
+        graph.link_fields(0, 3, TrustLevel::High);
+    };
+    GraphCore a(false);
+    GraphCore b(false);
+    build(a, 1, 2);
+    build(b, 2, 1);
+    EXPECT_EQ(a.structural_hash(), b.structural_hash());
+}
+
+// ============================================================================
+// Compact Export Tests
+// ============================================================================
+
+TEST(GraphCoreExportTests, Compact_MatchesFullExport)
+{
+    GraphCore graph(true);
+    for (StepIdx s = 0; s < 4; ++s)
+    {
+        graph.add_step(s);
+    }
+    graph.add_field(0, 0, typeid(int), Usage::Create);
+    graph.add_field(1, 1, typeid(int), Usage::Read);
+    graph.add_field(2, 2, typeid(int), Usage::Destroy);
+    graph.link_fields(0, 1, TrustLevel::High);
+    graph.link_fields(0, 2, TrustLevel::High);
+    graph.link_steps(2, 3, TrustLevel::High);
+    graph.link_steps(0, 3, TrustLevel::High);
+
+    auto full = graph.export_graph();
+    auto compact = graph.export_compact_graph();
+
+    auto as_vector = [](ConstArrayView<StepLinkPair> view)
+    {
+        return std::vector<StepLinkPair>(view.begin(), view.end());
+    };
+    EXPECT_EQ(compact->step_count, full->step_count);
+    EXPECT_EQ(compact->field_data_pairs, full->field_data_pairs);
+    EXPECT_EQ(compact->data_infos.size(), full->data_infos.size());
+    EXPECT_EQ(as_vector(compact->explicit_step_links()), full->explicit_step_links);
+    EXPECT_EQ(as_vector(compact->implicit_step_links()), full->implicit_step_links);
+    EXPECT_EQ(as_vector(compact->combined_step_links()), full->combined_step_links);
+    EXPECT_EQ(compact->step_links.size(),
+              full->explicit_step_links.size() + full->implicit_step_links.size());
+    EXPECT_EQ(compact->topological_order, full->topological_order);
+    EXPECT_EQ(compact->step_levels, full->step_levels);
+    EXPECT_EQ(compact->level_steps, full->level_steps);
+}
+
+TEST(GraphCoreExportTests, Compact_InvalidGraphThrows)
+{
+    GraphCore graph(false);
+    graph.add_step(0);
+    graph.add_field(0, 0, typeid(int), Usage::Read);
+    EXPECT_THROW(graph.export_compact_graph(), GraphCoreError);
+}
+
+// ============================================================================
+// Consuming Export Tests
+// ============================================================================
+
+TEST(GraphCoreExportTests, IntoExported_MatchesExportGraph)
+{
+    auto build = [](GraphCore& graph)
+    {
+        for (StepIdx s = 0; s < 4; ++s)
+        {
+            graph.add_step(s);
+        }
+        graph.add_field(0, 0, typeid(int), Usage::Create);
+        graph.add_field(1, 1, typeid(int), Usage::Read);
+        graph.add_field(2, 2, typeid(int), Usage::Destroy);
+        graph.add_field(3, 3, typeid(float), Usage::Create);
+        graph.link_fields(1, 0, TrustLevel::High);
+        graph.link_fields(2, 1, TrustLevel::High);
+        graph.link_steps(2, 3, TrustLevel::High);
+    };
+    GraphCore a(true);
+    GraphCore b(true);
+    build(a);
+    build(b);
+
+    auto expected = a.export_graph();
+    auto actual = std::move(b).into_exported();
+
+    EXPECT_EQ(actual->step_count, expected->step_count);
+    EXPECT_EQ(actual->field_data_pairs, expected->field_data_pairs);
+    ASSERT_EQ(actual->data_infos.size(), expected->data_infos.size());
+    for (size_t i = 0; i < actual->data_infos.size(); ++i)
+    {
+        EXPECT_EQ(actual->data_infos[i].ti, expected->data_infos[i].ti);
+        EXPECT_EQ(actual->data_infos[i].field_usages, expected->data_infos[i].field_usages);
+    }
+    EXPECT_EQ(actual->explicit_step_links, expected->explicit_step_links);
+    EXPECT_EQ(actual->implicit_step_links, expected->implicit_step_links);
+    EXPECT_EQ(actual->combined_step_links, expected->combined_step_links);
+    EXPECT_EQ(actual->topological_order, expected->topological_order);
+    EXPECT_EQ(actual->level_steps, expected->level_steps);
+}
+
+TEST(GraphCoreExportTests, IntoExported_InvalidGraphLeavesBuilderUsable)
+{
+    GraphCore graph(false);
+    graph.add_step(0);
+    graph.add_step(1);
+    graph.add_field(1, 0, typeid(int), Usage::Read);
+    graph.link_steps(0, 1, TrustLevel::High);
+
+    EXPECT_THROW(std::move(graph).into_exported(), GraphCoreError);
+
+    // Fix the error and export again
+    graph.add_field(0, 1, typeid(int), Usage::Create);
+    graph.link_fields(0, 1, TrustLevel::High);
+    auto exported = std::move(graph).into_exported();
+    EXPECT_EQ(exported->explicit_step_links, (std::vector<StepLinkPair>{{0, 1}}));
+    EXPECT_EQ(exported->field_data_pairs.size(), 2u);
+}
+
+TEST(GraphCoreExportTests, IntoExported_WithoutExplicitLinks)
+{
+    GraphCore graph(true);
+    graph.add_step(0);
+    graph.add_step(1);
+    graph.add_field(0, 0, typeid(int), Usage::Create);
+    graph.add_field(1, 1, typeid(int), Usage::Read);
+    graph.link_fields(0, 1, TrustLevel::High);
+    auto exported = std::move(graph).into_exported();
+
+    EXPECT_TRUE(exported->explicit_step_links.empty());
+    EXPECT_EQ(exported->implicit_step_links, (std::vector<StepLinkPair>{{0, 1}}));
+    EXPECT_EQ(exported->combined_step_links, (std::vector<StepLinkPair>{{0, 1}}));
+}
+
+TEST(GraphCoreExportTests, IntoExported_LeavesBuilderEmptyAndReusable)
+{
+    GraphCore graph(true);
+    graph.add_step(0);
+    graph.add_step(1);
+    graph.add_field(0, 0, typeid(int), Usage::Create);
+    graph.add_field(1, 1, typeid(int), Usage::Read);
+    graph.link_fields(0, 1, TrustLevel::High);
+    graph.link_steps(0, 1, TrustLevel::High);
+    auto first = std::move(graph).into_exported();
+    EXPECT_EQ(first->explicit_step_links, (std::vector<StepLinkPair>{{0, 1}}));
+
+    EXPECT_EQ(graph.step_count(), 0u);
+    EXPECT_EQ(graph.field_count(), 0u);
+    EXPECT_TRUE(graph.get_diagnostics(true)->is_valid());
+
+    graph.add_step(0);
+    graph.add_step(1);
+    graph.link_steps(1, 0, TrustLevel::High);
+    auto second = graph.export_graph();
+    EXPECT_EQ(second->explicit_step_links, (std::vector<StepLinkPair>{{1, 0}}));
+    EXPECT_EQ(second->combined_step_links, (std::vector<StepLinkPair>{{1, 0}}));
+}
+
+// ============================================================================
+// Caller-Provided Output Tests
+// ============================================================================
+
+TEST(GraphCoreExportTests, ExportInto_RefillsAndKeepsCapacity)
+{
+    GraphCore large(true);
+    for (StepIdx s = 0; s < 6; ++s)
+    {
+        large.add_step(s);
+    }
+    for (StepIdx s = 0; s < 5; ++s)
+    {
+        large.add_field(s, 2 * s, typeid(int), Usage::Create);
+        large.add_field(s + 1, 2 * s + 1, typeid(int), Usage::Read);
+        large.link_fields(2 * s, 2 * s + 1, TrustLevel::High);
+    }
+    large.link_steps(0, 5, TrustLevel::High);
+
+    GraphCore small(true);
+    small.add_step(0);
+    small.add_step(1);
+    small.add_field(0, 0, typeid(float), Usage::Create);
+    small.add_field(1, 1, typeid(float), Usage::Read);
+    small.link_fields(0, 1, TrustLevel::High);
+
+    ExportedGraph out;
+    large.export_graph_into(out);
+    const auto* combined_data = out.combined_step_links.data();
+    const auto* usages_data = out.data_infos[0].field_usages.data();
+
+    small.export_graph_into(out);
+    auto expected = small.export_graph();
+
+    EXPECT_EQ(out.step_count, 2u);
+    EXPECT_EQ(out.field_data_pairs, expected->field_data_pairs);
+    ASSERT_EQ(out.data_infos.size(), 1u);
+    EXPECT_EQ(out.data_infos[0].ti, std::type_index(typeid(float)));
+    EXPECT_EQ(out.data_infos[0].field_usages, expected->data_infos[0].field_usages);
+    EXPECT_EQ(out.explicit_step_links, expected->explicit_step_links);
+    EXPECT_EQ(out.combined_step_links, expected->combined_step_links);
+    EXPECT_EQ(out.topological_order, expected->topological_order);
+    EXPECT_EQ(out.level_offsets, expected->level_offsets);
+    EXPECT_EQ(out.combined_step_links.data(), combined_data);
+    EXPECT_EQ(out.data_infos[0].field_usages.data(), usages_data);
+}
+
+TEST(GraphCoreExportTests, DiagnosticsInto_ReplacesPreviousItems)
+{
+    GraphCore invalid(false);
+    invalid.add_step(0);
+    invalid.add_field(0, 0, typeid(int), Usage::Read);
+
+    GraphCore valid(false);
+    valid.add_step(0);
+    valid.add_field(0, 0, typeid(int), Usage::Create);
+
+    GraphCoreDiagnostics out;
+    invalid.get_diagnostics_into(out, true);
+    EXPECT_TRUE(out.has_errors());
+
+    valid.get_diagnostics_into(out, true);
+    EXPECT_FALSE(out.has_errors());
+    EXPECT_EQ(out.warnings().size(), valid.get_diagnostics(true)->warnings().size());
+}
+
+// ============================================================================
+// Clear and Reset Tests
+// ============================================================================
+
+namespace
+{
+
+void build_chain(GraphCore& graph, StepIdx length)
+{
+    for (StepIdx s = 0; s < length; ++s)
+    {
+        graph.add_step(s);
+    }
+    for (StepIdx s = 0; s + 1 < length; ++s)
+    {
+        graph.add_field(s, 2 * s, typeid(int), Usage::Create);
+        graph.add_field(s + 1, 2 * s + 1, typeid(int), Usage::Read);
+        graph.link_fields(2 * s, 2 * s + 1, TrustLevel::High);
+    }
+    graph.link_steps(0, length - 1, TrustLevel::Low);
+}
+
+} // namespace
+
+TEST(GraphCoreExportTests, Clear_RebuildMatchesFreshGraph)
+{
+    GraphCore reused(true);
+    build_chain(reused, 8);
+    reused.clear();
+    EXPECT_EQ(reused.step_count(), 0u);
+    EXPECT_EQ(reused.field_count(), 0u);
+    EXPECT_EQ(reused.structural_hash(), GraphCore(true).structural_hash());
+
+    build_chain(reused, 5);
+    GraphCore fresh(true);
+    build_chain(fresh, 5);
+
+    EXPECT_EQ(reused.structural_hash(), fresh.structural_hash());
+    auto a = reused.export_graph();
+    auto b = fresh.export_graph();
+    EXPECT_EQ(a->step_count, b->step_count);
+    EXPECT_EQ(a->field_data_pairs, b->field_data_pairs);
+    EXPECT_EQ(a->explicit_step_links, b->explicit_step_links);
+    EXPECT_EQ(a->implicit_step_links, b->implicit_step_links);
+    EXPECT_EQ(a->topological_order, b->topological_order);
+}
+
+TEST(GraphCoreExportTests, Clear_StillDetectsCycles)
+{
+    GraphCore graph(true);
+    build_chain(graph, 4);
+    graph.clear();
+
+    graph.add_step(0);
+    graph.add_step(1);
+    graph.link_steps(0, 1, TrustLevel::High);
+    EXPECT_THROW(graph.link_steps(1, 0, TrustLevel::High), GraphCoreError);
+}
+
+TEST(GraphCoreExportTests, Reset_ChangesValidationMode)
+{
+    GraphCore graph(true);
+    graph.add_step(0);
+    graph.add_step(1);
+    graph.link_steps(0, 1, TrustLevel::High);
+
+    // Deferred: the cycle is accepted and reported at export
+    graph.reset(false);
+    graph.add_step(0);
+    graph.add_step(1);
+    graph.link_steps(0, 1, TrustLevel::High);
+    EXPECT_NO_THROW(graph.link_steps(1, 0, TrustLevel::High));
+    EXPECT_THROW(graph.export_graph(), GraphCoreError);
+
+    graph.reset(true);
+    graph.add_step(0);
+    graph.add_step(1);
+    graph.link_steps(0, 1, TrustLevel::High);
+    EXPECT_THROW(graph.link_steps(1, 0, TrustLevel::High), GraphCoreError);
+}
+
+// ============================================================================
+// Parallel Field Linking Tests
+// ============================================================================
+
+TEST(GraphCoreExportTests, LinkFieldsParallel_MatchesSequentialLinking)
+{
+    // A chain of steps; each data object is created by one step and read by
+    // the next two. Links are given in scrambled order.
+    constexpr StepIdx steps = 200;
+    std::vector<std::pair<FieldIdx, FieldIdx>> links;
+    auto build = [&](GraphCore& graph)
+    {
+        FieldIdx fidx = 0;
+        for (StepIdx s = 0; s < steps; ++s)
+        {
+            graph.add_step(s);
+        }
+        links.clear();
+        for (StepIdx s = 0; s + 2 < steps; ++s)
+        {
+            graph.add_field(s, fidx, typeid(int), Usage::Create);
+            graph.add_field(s + 1, fidx + 1, typeid(int), Usage::Read);
+            graph.add_field(s + 2, fidx + 2, typeid(int), Usage::Read);
+            links.emplace_back(fidx + 2, fidx);
+            links.emplace_back(fidx, fidx + 1);
+            links.emplace_back(fidx + 1, fidx + 1);
+            fidx += 3;
+        }
+        std::reverse(links.begin(), links.end());
+    };
+
+    GraphCore sequential(false);
+    build(sequential);
+    for (const auto& [a, b] : links)
+    {
+        sequential.link_fields(a, b, TrustLevel::Middle);
+    }
+
+    GraphCore parallel(false);
+    build(parallel);
+    parallel.link_fields_parallel(links, TrustLevel::Middle, 4);
+
+    EXPECT_EQ(parallel.structural_hash(), sequential.structural_hash());
+    auto a = parallel.export_graph();
+    auto b = sequential.export_graph();
+    EXPECT_EQ(a->field_data_pairs, b->field_data_pairs);
+    EXPECT_EQ(a->implicit_step_links, b->implicit_step_links);
+    EXPECT_EQ(a->topological_order, b->topological_order);
+}
+
+TEST(GraphCoreExportTests, LinkFieldsParallel_RejectsBeforeApplying)
+{
+    GraphCore eager(true);
+    eager.add_step(0);
+    eager.add_field(0, 0, typeid(int), Usage::Create);
+    EXPECT_THROW(eager.link_fields_parallel({{0, 0}}, TrustLevel::High), GraphCoreError);
+
+    GraphCore graph(false);
+    graph.add_step(0);
+    graph.add_step(1);
+    graph.add_field(0, 0, typeid(int), Usage::Create);
+    graph.add_field(1, 1, typeid(int), Usage::Read);
+    graph.add_field(1, 2, typeid(float), Usage::Read);
+    const uint64_t hash = graph.structural_hash();
+
+    EXPECT_THROW(graph.link_fields_parallel({{0, 1}, {0, 2}}, TrustLevel::High), GraphCoreError);
+    EXPECT_THROW(graph.link_fields_parallel({{0, 1}, {0, 9}}, TrustLevel::High), GraphCoreError);
+    EXPECT_EQ(graph.structural_hash(), hash);
+    EXPECT_EQ(graph.export_valid_subgraph()->graph.implicit_step_links.size(), 0u);
+}
@@ -0,0 +1,81 @@
+/**
+ * @file graph_core_pool_tests.cpp
+ * @brief Unit tests for GraphCorePool
+ */
+#include <gtest/gtest.h>
+#include <thread>
+#include "crddagt/common/graph_core_pool.hpp"
+
+using namespace crddagt;
+
+TEST(GraphCorePoolTests, Acquire_EmptyPoolCreatesGraph)
+{
+    GraphCorePool pool;
+    auto graph = pool.acquire();
+    ASSERT_NE(graph, nullptr);
+    EXPECT_EQ(graph->step_count(), 0u);
+    EXPECT_EQ(pool.idle_count(), 0u);
+}
+
+TEST(GraphCorePoolTests, Release_GraphIsRecycledEmpty)
+{
+    GraphCorePool pool;
+    auto graph = pool.acquire();
+    graph->add_step(0);
+    graph->add_field(0, 0, typeid(int), Usage::Create);
+    const GraphCore* address = graph.get();
+
+    pool.release(std::move(graph));
+    EXPECT_EQ(pool.idle_count(), 1u);
+
+    auto recycled = pool.acquire(false);
+    EXPECT_EQ(recycled.get(), address);
+    EXPECT_EQ(recycled->step_count(), 0u);
+    EXPECT_EQ(recycled->field_count(), 0u);
+    EXPECT_EQ(pool.idle_count(), 0u);
+
+    // Deferred mode, as requested
+    recycled->add_step(0);
+    recycled->add_step(1);
+    recycled->link_steps(0, 1, TrustLevel::High);
+    EXPECT_NO_THROW(recycled->link_steps(1, 0, TrustLevel::High));
+}
+
+TEST(GraphCorePoolTests, Release_BeyondMaxIdleDiscards)
+{
+    GraphCorePool pool(1);
+    auto a = pool.acquire();
+    auto b = pool.acquire();
+    pool.release(std::move(a));
+    pool.release(std::move(b));
+    pool.release(nullptr);
+    EXPECT_EQ(pool.idle_count(), 1u);
+}
+
+TEST(GraphCorePoolTests, ConcurrentWorkers)
+{
+    GraphCorePool pool(4);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 4; ++t)
+    {
+        workers.emplace_back([&pool]() {
+            for (int round = 0; round < 50; ++round)
+            {
+                auto graph = pool.acquire();
+                graph->add_step(0);
+                graph->add_step(1);
+                graph->add_field(0, 0, typeid(int), Usage::Create);
+                graph->add_field(1, 1, typeid(int), Usage::Read);
+                graph->link_fields(0, 1, TrustLevel::High);
+                EXPECT_EQ(graph->export_graph()->implicit_step_links.size(), 1u);
+                pool.release(std::move(graph));
+            }
+        });
+    }
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+    EXPECT_GE(pool.idle_count(), 1u);
+    EXPECT_LE(pool.idle_count(), 4u);
+}
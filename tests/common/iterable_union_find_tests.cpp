@@ -1,7 +1,10 @@
 #include <gtest/gtest.h>
 #include <algorithm>
-// #include <chrono> // for human review of potentially slow tests only.
+#include <chrono>
+#include <iostream>
+#include <random>
 #include <set>
+#include <thread>
 #include <numeric>
 #include "crddagt/common/iterable_union_find.inline.hpp"
 
@@ -1010,3 +1013,572 @@ TEST(IterableUnionFindTests, GetClasses_CountMatchesNumClasses) {
     uf.get_classes(classes);
     EXPECT_EQ(classes.size(), uf.num_classes());
 }
+
+TEST(IterableUnionFindTests, Clear_EmptiesAndKeepsCapacity) {
+    IterableUnionFind<size_t> uf;
+    uf.init_sets(100);
+    uf.unite(0, 1);
+    uf.clear();
+    EXPECT_EQ(uf.element_count(), 0u);
+    EXPECT_EQ(uf.num_classes(), 0u);
+
+    uf.init_sets(3);
+    EXPECT_EQ(uf.num_classes(), 3u);
+    EXPECT_FALSE(uf.same_class(0, 1));
+}
+
+TEST(IterableUnionFindTests, Flatten_EveryParentIsRoot) {
+    IterableUnionFind<size_t> uf;
+    uf.init_sets(16);
+    for (size_t i = 0; i + 2 < 16; i += 2) {
+        uf.unite(i, i + 1);
+    }
+    for (size_t i = 0; i + 2 < 16; i += 4) {
+        uf.unite(i, i + 2);
+    }
+    uf.unite(0, 4);
+    EXPECT_FALSE(uf.is_flat());
+
+    std::vector<size_t> roots_before;
+    uf.get_roots(roots_before);
+    uf.flatten();
+    EXPECT_TRUE(uf.is_flat());
+
+    std::vector<IterableUnionFind<size_t>::Node> nodes;
+    uf.export_nodes(nodes);
+    for (size_t i = 0; i < 16; ++i) {
+        EXPECT_EQ(nodes[i].parent, roots_before[i]);
+        EXPECT_EQ(nodes[nodes[i].parent].parent, nodes[i].parent);
+        EXPECT_EQ(uf.class_root(i), roots_before[i]);
+    }
+}
+
+TEST(IterableUnionFindTests, IsFlat_KeptBySingletonMergesOnly) {
+    IterableUnionFind<size_t> uf;
+    EXPECT_TRUE(uf.is_flat());
+    uf.init_sets(6);
+    EXPECT_TRUE(uf.is_flat());
+
+    uf.unite(0, 1);
+    uf.unite(0, 2);
+    uf.unite(3, 0);
+    EXPECT_TRUE(uf.is_flat());
+    uf.make_set();
+    EXPECT_TRUE(uf.is_flat());
+
+    uf.unite(4, 5);
+    uf.unite(0, 4);
+    EXPECT_FALSE(uf.is_flat());
+    EXPECT_TRUE(uf.same_class(1, 5));
+
+    uf.clear();
+    EXPECT_TRUE(uf.is_flat());
+}
+
+TEST(IterableUnionFindTests, GetRoots_MatchesClassRoot) {
+    IterableUnionFind<uint32_t> uf;
+    uf.init_sets(50);
+    for (uint32_t i = 0; i + 1 < 50; ++i) {
+        if (i % 7 != 6) {
+            uf.unite(i, i + 1);
+        }
+    }
+    uf.unite(3, 40);
+
+    std::vector<uint32_t> roots;
+    uf.get_roots(roots);
+    ASSERT_EQ(roots.size(), 50u);
+    for (uint32_t i = 0; i < 50; ++i) {
+        EXPECT_EQ(roots[i], uf.class_root(i));
+    }
+
+    uf.flatten();
+    std::vector<uint32_t> flat_roots;
+    uf.get_roots(flat_roots);
+    EXPECT_EQ(flat_roots, roots);
+}
+
+TEST(IterableUnionFindTests, ExportNodes_ReportsSeparatelyStoredArrays) {
+    // Balanced pairwise merges reach rank 10 over 1024 elements
+    IterableUnionFind<uint16_t> uf;
+    uf.init_sets(1024);
+    for (uint16_t width = 1; width < 1024; width *= 2) {
+        for (uint16_t i = 0; i < 1024; i += 2 * width) {
+            uf.unite(i, static_cast<uint16_t>(i + width));
+        }
+    }
+    EXPECT_EQ(uf.class_rank(0), 10u);
+
+    std::vector<IterableUnionFind<uint16_t>::Node> nodes;
+    uf.export_nodes(nodes);
+    ASSERT_EQ(nodes.size(), 1024u);
+    const uint16_t root = uf.class_root(0);
+    EXPECT_EQ(nodes[root].parent, root);
+    EXPECT_EQ(nodes[root].rank, 10u);
+    EXPECT_EQ(nodes[root].size, 1024u);
+
+    // The next pointers form a single cycle over all elements
+    size_t steps = 0;
+    uint16_t x = 0;
+    do {
+        x = nodes[x].next;
+        ++steps;
+    } while (x != 0);
+    EXPECT_EQ(steps, 1024u);
+}
+
+TEST(IterableUnionFindTests, Rollback_RestoresNodesExactly) {
+    IterableUnionFind<uint32_t> uf;
+    uf.init_sets(12);
+    uf.unite(0, 1);
+    uf.unite(2, 3);
+    uf.unite(1, 3);
+    uf.unite(4, 5);
+
+    std::vector<IterableUnionFind<uint32_t>::Node> before;
+    uf.export_nodes(before);
+    const bool flat_before = uf.is_flat();
+
+    auto cp = uf.checkpoint();
+    EXPECT_EQ(uf.checkpoint_depth(), 1u);
+    uf.unite(3, 5);
+    uf.unite(6, 7);
+    uf.unite(7, 0);
+    uf.unite(8, 9);
+    uf.find(9);
+    uint32_t created = uf.make_set();
+    uf.unite(created, 11);
+    EXPECT_EQ(uf.class_size(0), 8u);
+
+    uf.rollback(cp);
+    EXPECT_EQ(uf.checkpoint_depth(), 0u);
+    EXPECT_EQ(uf.element_count(), 12u);
+    EXPECT_EQ(uf.is_flat(), flat_before);
+
+    std::vector<IterableUnionFind<uint32_t>::Node> after;
+    uf.export_nodes(after);
+    ASSERT_EQ(after.size(), before.size());
+    for (size_t i = 0; i < before.size(); ++i) {
+        EXPECT_EQ(after[i].parent, before[i].parent) << i;
+        EXPECT_EQ(after[i].rank, before[i].rank) << i;
+        EXPECT_EQ(after[i].size, before[i].size) << i;
+        EXPECT_EQ(after[i].next, before[i].next) << i;
+    }
+}
+
+TEST(IterableUnionFindTests, Checkpoint_NestedCommitAndRollback) {
+    IterableUnionFind<size_t> uf;
+    uf.init_sets(6);
+
+    auto outer = uf.checkpoint();
+    uf.unite(0, 1);
+    auto inner = uf.checkpoint();
+    uf.unite(2, 3);
+    EXPECT_THROW(uf.commit(outer), std::logic_error);
+    EXPECT_THROW(uf.flatten(), std::logic_error);
+    uf.commit(inner);
+    EXPECT_TRUE(uf.same_class(2, 3));
+
+    inner = uf.checkpoint();
+    uf.unite(4, 5);
+    uf.rollback(inner);
+    EXPECT_FALSE(uf.same_class(4, 5));
+    EXPECT_TRUE(uf.same_class(0, 1));
+
+    // The committed inner changes belong to the outer checkpoint
+    uf.rollback(outer);
+    EXPECT_EQ(uf.num_classes(), 6u);
+    std::vector<size_t> members;
+    uf.get_class_members(2, members);
+    EXPECT_EQ(members, std::vector<size_t>{2});
+    EXPECT_THROW(uf.rollback(outer), std::logic_error);
+}
+
+TEST(IterableUnionFindTests, Checkpoint_RollbackToCommittedCheckpointThrows) {
+    IterableUnionFind<size_t> uf;
+    uf.init_sets(1);
+
+    auto cp1 = uf.checkpoint();
+    uf.make_set();
+    uf.make_set();
+    uf.unite(0, 1);
+    uf.unite(1, 2);
+    uf.commit(cp1);
+    auto cp2 = uf.checkpoint();  // same depth as the closed cp1
+    EXPECT_THROW(uf.rollback(cp1), std::logic_error);
+    EXPECT_THROW(uf.commit(cp1), std::logic_error);
+
+    // Nothing was undone, and cp2 is still usable
+    EXPECT_EQ(uf.element_count(), 3u);
+    EXPECT_EQ(uf.num_classes(), 1u);
+    uf.rollback(cp2);
+    EXPECT_EQ(uf.checkpoint_depth(), 0u);
+    EXPECT_EQ(uf.class_size(0), 3u);
+}
+
+TEST(IterableUnionFindTests, Checkpoint_CommitReenablesCompression) {
+    IterableUnionFind<size_t> uf;
+    uf.init_sets(4);
+    auto cp = uf.checkpoint();
+    uf.unite(0, 1);
+    uf.unite(2, 3);
+    uf.unite(0, 2);
+    uf.commit(cp);
+    EXPECT_FALSE(uf.is_flat());
+    uf.flatten();
+    EXPECT_TRUE(uf.is_flat());
+    EXPECT_EQ(uf.class_size(3), 4u);
+}
+
+namespace {
+
+struct CountAndMask {
+    size_t count = 1;
+    uint32_t mask = 0;
+
+    void merge(const CountAndMask& other) {
+        count += other.count;
+        mask |= other.mask;
+    }
+};
+
+} // namespace
+
+TEST(IterableUnionFindTests, ClassAggregate_MergedByUnite) {
+    IterableUnionFind<uint32_t, CountAndMask> uf;
+    for (uint32_t i = 0; i < 6; ++i) {
+        uf.make_set(CountAndMask{1, 1u << i});
+    }
+    uf.unite(0, 1);
+    uf.unite(2, 3);
+    uf.unite(3, 1);
+
+    EXPECT_EQ(uf.class_aggregate(2).count, 4u);
+    EXPECT_EQ(uf.class_aggregate(0).mask, 0x0Fu);
+    EXPECT_EQ(uf.class_aggregate(4).mask, 0x10u);
+
+    // init_sets and make_set() use the default value
+    uf.make_set();
+    uf.unite(6, 5);
+    EXPECT_EQ(uf.class_aggregate(6).count, 2u);
+    EXPECT_EQ(uf.class_aggregate(6).mask, 0x20u);
+}
+
+TEST(IterableUnionFindTests, ClassAggregate_RestoredByRollback) {
+    IterableUnionFind<size_t, CountAndMask> uf;
+    uf.init_sets(4);
+    uf.unite(0, 1);
+
+    auto cp = uf.checkpoint();
+    uf.unite(2, 3);
+    uf.unite(0, 3);
+    uf.make_set(CountAndMask{10, 0});
+    uf.unite(4, 0);
+    EXPECT_EQ(uf.class_aggregate(1).count, 14u);
+
+    uf.rollback(cp);
+    EXPECT_EQ(uf.class_aggregate(1).count, 2u);
+    EXPECT_EQ(uf.class_aggregate(2).count, 1u);
+    EXPECT_EQ(uf.class_aggregate(3).count, 1u);
+}
+
+TEST(IterableUnionFindTests, InitFromEdges_MatchesSequentialUnite) {
+    constexpr uint32_t n = 30000;
+    std::vector<std::pair<uint32_t, uint32_t>> edges;
+    uint64_t state = 7;
+    auto next = [&state]() {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        return static_cast<uint32_t>((state >> 33) % n);
+    };
+    for (size_t e = 0; e < 20000; ++e) {
+        edges.emplace_back(next(), next());
+    }
+
+    IterableUnionFind<uint32_t> expected;
+    expected.init_sets(n);
+    for (const auto& [a, b] : edges) {
+        expected.unite(a, b);
+    }
+
+    IterableUnionFind<uint32_t> uf;
+    uf.init_from_edges(n, edges, 4);
+    EXPECT_TRUE(uf.is_flat());
+    EXPECT_EQ(uf.element_count(), n);
+    EXPECT_EQ(uf.num_classes(), expected.num_classes());
+
+    std::vector<uint32_t> members;
+    for (uint32_t i = 0; i < n; ++i) {
+        ASSERT_EQ(uf.class_size(i), expected.class_size(i));
+        const uint32_t root = uf.class_root(i);
+        if (root != i) {
+            continue;
+        }
+        // The root is the smallest member, and members follow in increasing order
+        uf.get_class_members(root, members);
+        ASSERT_EQ(members.size(), expected.class_size(root));
+        EXPECT_TRUE(std::is_sorted(members.begin(), members.end()));
+        for (uint32_t m : members) {
+            EXPECT_TRUE(expected.same_class(root, m));
+        }
+    }
+}
+
+TEST(IterableUnionFindTests, InitFromEdges_AggregatesAndErrors) {
+    IterableUnionFind<size_t, CountAndMask> uf;
+    uf.init_from_edges(5, {{4, 2}, {2, 0}, {3, 3}}, 2);
+    EXPECT_EQ(uf.class_root(4), 0u);
+    EXPECT_EQ(uf.class_aggregate(2).count, 3u);
+    EXPECT_EQ(uf.class_aggregate(3).count, 1u);
+    std::vector<size_t> members;
+    uf.get_class_members(4, members);
+    EXPECT_EQ(members, (std::vector<size_t>{4, 0, 2}));
+
+    EXPECT_THROW(uf.init_from_edges(5, {}), std::logic_error);
+    IterableUnionFind<size_t> empty;
+    EXPECT_THROW(empty.init_from_edges(3, {{0, 3}}), std::runtime_error);
+    EXPECT_EQ(empty.element_count(), 0u);
+}
+
+TEST(IterableUnionFindTests, RelabelDense_FirstAppearanceOrder) {
+    IterableUnionFind<size_t> uf;
+    uf.init_sets(7);
+    uf.unite(6, 1);
+    uf.unite(5, 3);
+    uf.unite(3, 0);
+
+    std::vector<size_t> element_to_class;
+    EXPECT_EQ(uf.relabel_dense(element_to_class), 4u);
+    EXPECT_EQ(element_to_class, (std::vector<size_t>{0, 1, 2, 0, 3, 0, 1}));
+}
+
+TEST(IterableUnionFindTests, ExportClassesCsr_MembersContiguousAndSorted) {
+    IterableUnionFind<uint16_t> uf;
+    uf.init_sets(7);
+    uf.unite(6, 1);
+    uf.unite(5, 3);
+    uf.unite(3, 0);
+
+    std::vector<size_t> offsets;
+    std::vector<uint16_t> members;
+    uf.export_classes_csr(offsets, members);
+    EXPECT_EQ(offsets, (std::vector<size_t>{0, 3, 5, 6, 7}));
+    EXPECT_EQ(members, (std::vector<uint16_t>{0, 3, 5, 1, 6, 2, 4}));
+
+    std::vector<uint16_t> wrong_size(3);
+    EXPECT_THROW(uf.export_classes_csr(wrong_size, offsets, members), std::invalid_argument);
+
+    // Labels that are not dense in first-appearance order are rejected
+    IterableUnionFind<uint16_t> pair;
+    pair.init_sets(2);
+    EXPECT_THROW(pair.export_classes_csr(std::vector<uint16_t>{1, 0}, offsets, members),
+                 std::invalid_argument);
+    EXPECT_THROW(pair.export_classes_csr(std::vector<uint16_t>{0, 2}, offsets, members),
+                 std::invalid_argument);
+
+    IterableUnionFind<uint16_t> empty;
+    empty.export_classes_csr(offsets, members);
+    EXPECT_EQ(offsets, std::vector<size_t>{0});
+    EXPECT_TRUE(members.empty());
+}
+
+TEST(IterableUnionFindTests, Snapshot_UnaffectedByLaterChanges) {
+    SnapshotUnionFind<uint32_t, CountAndMask> uf;
+    for (uint32_t i = 0; i < 10000; ++i) {
+        uf.make_set(CountAndMask{1, 1u << (i % 4)});
+    }
+    uf.unite(0, 1);
+    uf.unite(9000, 9001);
+
+    std::vector<SnapshotUnionFind<uint32_t, CountAndMask>::Node> before;
+    uf.export_nodes(before);
+    auto snap = uf.snapshot();
+
+    uf.unite(1, 9999);
+    uf.unite(2, 3);
+    uf.make_set();
+    uf.flatten();
+
+    std::vector<SnapshotUnionFind<uint32_t, CountAndMask>::Node> after;
+    snap.export_nodes(after);
+    ASSERT_EQ(after.size(), before.size());
+    for (size_t i = 0; i < before.size(); ++i) {
+        EXPECT_EQ(after[i].parent, before[i].parent);
+        EXPECT_EQ(after[i].rank, before[i].rank);
+        EXPECT_EQ(after[i].size, before[i].size);
+        EXPECT_EQ(after[i].next, before[i].next);
+    }
+    EXPECT_EQ(snap.class_aggregate(0).count, 2u);
+    EXPECT_FALSE(snap.same_class(0, 9999));
+
+    EXPECT_TRUE(uf.same_class(0, 9999));
+    EXPECT_EQ(uf.class_size(9999), 3u);
+    EXPECT_EQ(uf.class_aggregate(9999).count, 3u);
+    EXPECT_EQ(uf.element_count(), 10001u);
+
+    // Changing the snapshot leaves the original alone
+    snap.unite(4, 5);
+    EXPECT_FALSE(uf.same_class(4, 5));
+}
+
+TEST(IterableUnionFindTests, Snapshot_ReadOnAnotherThreadWhileModified) {
+    SnapshotUnionFind<uint32_t> uf;
+    uf.init_sets(20000);
+    for (int round = 0; round < 4; ++round) {
+        auto snap = uf.snapshot();
+        const size_t expected_classes = snap.num_classes();
+        std::thread reader([snap = std::move(snap), expected_classes]() mutable {
+            EXPECT_EQ(snap.num_classes(), expected_classes);
+            std::vector<uint32_t> roots;
+            snap.get_roots(roots);
+            EXPECT_EQ(roots.size(), 20000u);
+            // Destroyed here, while the writer may still be uniting
+        });
+        for (uint32_t i = round; i + 4 < 20000; i += 8) {
+            uf.unite(i, i + 4);
+        }
+        reader.join();
+    }
+    EXPECT_LT(uf.num_classes(), 20000u);
+}
+
+TEST(IterableUnionFindTests, Snapshot_DuringCheckpointThenRollback) {
+    SnapshotUnionFind<size_t> uf;
+    uf.init_sets(8);
+    uf.unite(0, 1);
+    auto cp = uf.checkpoint();
+    uf.unite(2, 3);
+    auto snap = uf.snapshot();
+    EXPECT_EQ(snap.checkpoint_depth(), 0u);
+    uf.rollback(cp);
+
+    EXPECT_FALSE(uf.same_class(2, 3));
+    EXPECT_TRUE(snap.same_class(2, 3));
+    EXPECT_TRUE(snap.same_class(0, 1));
+    EXPECT_EQ(snap.find(3), snap.find(2));
+}
+
+TEST(IterableUnionFindTests, FindBatch_MatchesClassRoot) {
+    IterableUnionFind<uint32_t> uf;
+    uf.init_sets(5000);
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<uint32_t> pick(0, 4999);
+    for (int i = 0; i < 3000; ++i) {
+        uf.unite(pick(rng), pick(rng));
+    }
+    ASSERT_FALSE(uf.is_flat());
+
+    std::vector<uint32_t> elements(7000);
+    for (auto& e : elements) {
+        e = pick(rng);
+    }
+    std::vector<uint32_t> roots(elements.size());
+    uf.find_batch(elements.data(), roots.data(), elements.size());
+    for (size_t i = 0; i < elements.size(); ++i) {
+        EXPECT_EQ(roots[i], uf.class_root(elements[i]));
+    }
+
+    // In place, and on the flat structure
+    uf.flatten();
+    std::vector<uint32_t> in_place = elements;
+    uf.find_batch(in_place.data(), in_place.data(), in_place.size());
+    EXPECT_EQ(in_place, roots);
+
+    uf.find_batch(nullptr, nullptr, 0);
+    std::vector<uint32_t> bad{1, 5000};
+    std::vector<uint32_t> untouched{9, 9};
+    EXPECT_THROW(uf.find_batch(bad.data(), untouched.data(), bad.size()), std::runtime_error);
+    EXPECT_EQ(untouched, (std::vector<uint32_t>{9, 9}));
+}
+
+// Benchmark for human review: run with --gtest_also_run_disabled_tests
+TEST(IterableUnionFindTests, DISABLED_FindBatch_BenchmarkAgainstScalarLoop) {
+    constexpr uint32_t n = 1u << 23;  // 32 MiB of parent entries
+    IterableUnionFind<uint32_t> uf;
+    uf.init_sets(n);
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<uint32_t> pick(0, n - 1);
+    for (uint32_t i = 0; i < n / 2; ++i) {
+        uf.unite(pick(rng), pick(rng));
+    }
+    std::vector<uint32_t> elements(n);
+    std::iota(elements.begin(), elements.end(), 0u);
+    std::shuffle(elements.begin(), elements.end(), rng);
+
+    std::vector<uint32_t> scalar(n);
+    std::vector<uint32_t> batched(n);
+    auto time_ms = [](auto&& body) {
+        auto start = std::chrono::steady_clock::now();
+        body();
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+    };
+    for (int flat = 0; flat < 2; ++flat) {
+        if (flat) {
+            uf.flatten();
+        }
+        auto scalar_ms = time_ms([&] {
+            for (uint32_t i = 0; i < n; ++i) {
+                scalar[i] = uf.class_root(elements[i]);
+            }
+        });
+        auto batched_ms = time_ms([&] { uf.find_batch(elements.data(), batched.data(), n); });
+        EXPECT_EQ(scalar, batched);
+        std::cout << "  [INFO] " << (flat ? "flat" : "unflattened") << ": class_root loop "
+                  << scalar_ms << " ms, find_batch " << batched_ms << " ms" << std::endl;
+    }
+}
+
+TEST(IterableUnionFindTests, NumClasses_TrackedThroughUniteRollbackAndSnapshot) {
+    auto expect_consistent = [](const IterableUnionFind<uint32_t>& u) {
+        std::vector<uint32_t> expected;
+        for (uint32_t i = 0; i < u.element_count(); ++i) {
+            if (u.class_root(i) == i) {
+                expected.push_back(i);
+            }
+        }
+        std::vector<uint32_t> roots;
+        u.get_class_representatives(roots);
+        EXPECT_EQ(roots, expected);
+        EXPECT_EQ(u.num_classes(), expected.size());
+    };
+
+    for (bool with_root_list : {false, true}) {
+        SCOPED_TRACE(with_root_list ? "with root list" : "without root list");
+        IterableUnionFind<uint32_t> uf;
+        uf.init_sets(300);
+        std::mt19937 rng(3);
+        std::uniform_int_distribution<uint32_t> pick(0, 299);
+
+        for (int i = 0; i < 100; ++i) {
+            uf.unite(pick(rng), pick(rng));
+        }
+        if (with_root_list) {
+            uf.enable_root_list();  // built from the current partition
+        }
+        EXPECT_EQ(uf.has_root_list(), with_root_list);
+        expect_consistent(uf);
+
+        IterableUnionFind<uint32_t> snap = uf;  // a deep copy with the default storage
+        auto cp = uf.checkpoint();
+        for (int i = 0; i < 100; ++i) {
+            uf.unite(pick(rng), pick(rng));
+            uf.unite(uf.make_set(), pick(rng));
+        }
+        expect_consistent(uf);
+        uf.rollback(cp);
+        expect_consistent(uf);
+        EXPECT_EQ(uf.num_classes(), snap.num_classes());
+        expect_consistent(snap);
+
+        IterableUnionFind<uint32_t> from_edges;
+        if (with_root_list) {
+            from_edges.enable_root_list();
+        }
+        from_edges.init_from_edges(6, {{4, 5}, {1, 4}});
+        EXPECT_EQ(from_edges.num_classes(), 4u);
+        expect_consistent(from_edges);
+        from_edges.clear();
+        EXPECT_EQ(from_edges.num_classes(), 0u);
+        EXPECT_FALSE(from_edges.has_root_list());
+    }
+}
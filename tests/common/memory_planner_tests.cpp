@@ -0,0 +1,226 @@
+/**
+ * @file memory_planner_tests.cpp
+ * @brief Unit tests for plan_memory()
+ */
+#include <gtest/gtest.h>
+#include <random>
+#include "crddagt/common/graph_core.hpp"
+#include "crddagt/common/memory_planner.hpp"
+#include "crddagt/common/step_graph_algorithms.hpp"
+
+using namespace crddagt;
+
+namespace
+{
+
+/// Brute-force transitive closure of the combined step links.
+std::vector<std::vector<bool>> brute_force_reach(const ExportedGraph& exported)
+{
+    const size_t n = exported.step_count;
+    std::vector<std::vector<bool>> reach(n, std::vector<bool>(n, false));
+    for (const auto& [a, b] : exported.combined_step_links)
+    {
+        reach[a][b] = true;
+    }
+    for (size_t k = 0; k < n; ++k)
+        for (size_t i = 0; i < n; ++i)
+            for (size_t j = 0; j < n; ++j)
+                if (reach[i][k] && reach[k][j])
+                    reach[i][j] = true;
+    return reach;
+}
+
+StepIdx create_step_of(const DataInfo& info)
+{
+    for (const auto& [s, f, u] : info.field_usages)
+    {
+        if (u == Usage::Create)
+        {
+            return s;
+        }
+    }
+    return 0;
+}
+
+/// True if every use of a happens before b is created.
+bool precedes(const std::vector<std::vector<bool>>& reach, const DataInfo& a, const DataInfo& b)
+{
+    for (const auto& [s, f, u] : a.field_usages)
+    {
+        if (!reach[s][create_step_of(b)])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Checks that objects sharing a slot are of its type and ordered by the links.
+void expect_plan_is_safe(const ExportedGraph& exported, const MemoryPlan& plan)
+{
+    auto reach = brute_force_reach(exported);
+
+    for (size_t slot = 0; slot < plan.slot_count(); ++slot)
+    {
+        for (size_t i = plan.slot_offsets[slot]; i + 1 < plan.slot_offsets[slot + 1]; ++i)
+        {
+            const DataInfo& a = exported.data_infos[plan.slot_data[i]];
+            const DataInfo& b = exported.data_infos[plan.slot_data[i + 1]];
+            EXPECT_EQ(a.ti, plan.slot_types[slot]);
+            EXPECT_EQ(b.ti, plan.slot_types[slot]);
+            EXPECT_TRUE(precedes(reach, a, b)) << "data " << a.didx << " vs data " << b.didx;
+        }
+    }
+}
+
+} // namespace
+
+TEST(MemoryPlannerTests, Pipeline_SameTypeSharesTwoSlots)
+{
+    // 0 -> 1 -> 2 -> 3, step s creates an int read by step s + 1.
+    // Consecutive ints overlap at the step that reads one and creates the next.
+    GraphCore graph(true);
+    for (StepIdx s = 0; s < 4; ++s)
+    {
+        graph.add_step(s);
+    }
+    for (StepIdx s = 0; s < 3; ++s)
+    {
+        graph.add_field(s, 2 * s, typeid(int), Usage::Create);
+        graph.add_field(s + 1, 2 * s + 1, typeid(int), Usage::Read);
+        graph.link_fields(2 * s, 2 * s + 1, TrustLevel::High);
+    }
+    auto exported = graph.export_graph();
+
+    auto plan = plan_memory(*exported, {{typeid(int), 100}});
+
+    EXPECT_EQ(plan->slot_count(), 2u);
+    EXPECT_EQ(plan->data_slots, (std::vector<size_t>{0, 1, 0}));
+    EXPECT_EQ(plan->slot_offsets, (std::vector<size_t>{0, 2, 3}));
+    EXPECT_EQ(plan->slot_data, (std::vector<DataIdx>{0, 2, 1}));
+    EXPECT_EQ(plan->bytes_without_sharing, 300u);
+    EXPECT_EQ(plan->bytes_with_sharing, 200u);
+    expect_plan_is_safe(*exported, *plan);
+}
+
+TEST(MemoryPlannerTests, UnorderedObjectsDoNotShare)
+{
+    // Two independent producer/consumer pairs
+    GraphCore graph(true);
+    for (StepIdx s = 0; s < 4; ++s)
+    {
+        graph.add_step(s);
+    }
+    graph.add_field(0, 0, typeid(int), Usage::Create);
+    graph.add_field(1, 1, typeid(int), Usage::Read);
+    graph.add_field(2, 2, typeid(int), Usage::Create);
+    graph.add_field(3, 3, typeid(int), Usage::Read);
+    graph.link_fields(0, 1, TrustLevel::High);
+    graph.link_fields(2, 3, TrustLevel::High);
+    auto exported = graph.export_graph();
+
+    EXPECT_EQ(plan_memory(*exported)->slot_count(), 2u);
+
+    // Ordering the pairs lets them share
+    graph.link_steps(1, 2, TrustLevel::High);
+    auto ordered = graph.export_graph();
+    auto plan = plan_memory(*ordered);
+    EXPECT_EQ(plan->slot_count(), 1u);
+    expect_plan_is_safe(*ordered, *plan);
+}
+
+TEST(MemoryPlannerTests, DifferentTypesNeverShare)
+{
+    GraphCore graph(true);
+    graph.add_step(0);
+    graph.add_step(1);
+    graph.add_field(0, 0, typeid(int), Usage::Create);
+    graph.add_field(1, 1, typeid(float), Usage::Create);
+    graph.link_steps(0, 1, TrustLevel::High);
+    auto exported = graph.export_graph();
+
+    auto plan = plan_memory(*exported);
+
+    EXPECT_EQ(plan->slot_count(), 2u);
+    ASSERT_EQ(plan->per_type.size(), 2u);
+    EXPECT_EQ(plan->per_type[0].slot_count, 1u);
+    EXPECT_EQ(plan->per_type[1].slot_count, 1u);
+}
+
+TEST(MemoryPlannerTests, DestroyEndsLifetime)
+{
+    // Data A: created by 0, read by 1, destroyed by 2. Data B created by 3.
+    // Only the destroyer needs to precede B's creator.
+    GraphCore graph(true);
+    for (StepIdx s = 0; s < 4; ++s)
+    {
+        graph.add_step(s);
+    }
+    graph.add_field(0, 0, typeid(int), Usage::Create);
+    graph.add_field(1, 1, typeid(int), Usage::Read);
+    graph.add_field(2, 2, typeid(int), Usage::Destroy);
+    graph.add_field(3, 3, typeid(int), Usage::Create);
+    graph.link_fields(0, 1, TrustLevel::High);
+    graph.link_fields(0, 2, TrustLevel::High);
+    graph.link_steps(2, 3, TrustLevel::High);
+    auto exported = graph.export_graph();
+
+    EXPECT_EQ(plan_memory(*exported)->slot_count(), 1u);
+}
+
+TEST(MemoryPlannerTests, RandomGraphs_PlanIsSafeAndMinimalOnChains)
+{
+    std::mt19937 rng(12345);
+    for (int round = 0; round < 20; ++round)
+    {
+        const size_t steps = 12;
+        GraphCore graph(true);
+        for (StepIdx s = 0; s < steps; ++s)
+        {
+            graph.add_step(s);
+        }
+        // Random forward links keep the graph acyclic
+        for (int k = 0; k < 15; ++k)
+        {
+            StepIdx a = rng() % steps;
+            StepIdx b = rng() % steps;
+            if (a < b)
+            {
+                graph.link_steps(a, b, TrustLevel::High);
+            }
+        }
+        // Each data object: created at a, read at a later step
+        FieldIdx f = 0;
+        for (int k = 0; k < 8; ++k)
+        {
+            StepIdx a = rng() % (steps - 1);
+            StepIdx b = a + 1 + rng() % (steps - 1 - a);
+            graph.add_field(a, f, typeid(int), Usage::Create);
+            graph.add_field(b, f + 1, typeid(int), Usage::Read);
+            graph.link_fields(f, f + 1, TrustLevel::High);
+            f += 2;
+        }
+        auto exported = graph.export_graph();
+        auto plan = plan_memory(*exported);
+        expect_plan_is_safe(*exported, *plan);
+
+        // By Dilworth's theorem, the fewest chains equals the largest antichain
+        auto reach = brute_force_reach(*exported);
+        const auto& infos = exported->data_infos;
+        size_t largest_antichain = 0;
+        for (uint32_t subset = 1; subset < (1u << infos.size()); ++subset)
+        {
+            bool antichain = true;
+            for (size_t i = 0; i < infos.size() && antichain; ++i)
+                for (size_t j = 0; j < infos.size() && antichain; ++j)
+                    if (i != j && (subset >> i & 1) && (subset >> j & 1) &&
+                        precedes(reach, infos[i], infos[j]))
+                        antichain = false;
+            if (antichain)
+            {
+                largest_antichain = std::max<size_t>(largest_antichain, __builtin_popcount(subset));
+            }
+        }
+        EXPECT_EQ(plan->slot_count(), largest_antichain);
+    }
+}
@@ -0,0 +1,217 @@
+/**
+ * @file step_graph_algorithms_tests.cpp
+ * @brief Unit tests for step_graph_algorithms.hpp
+ */
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include "crddagt/common/step_graph_algorithms.hpp"
+
+using namespace crddagt;
+
+namespace
+{
+
+/// Reachability matrix by repeated DFS, for small graphs only.
+std::vector<std::vector<bool>> brute_force_reachability(
+    size_t step_count, const std::vector<StepLinkPair>& links)
+{
+    std::vector<std::vector<StepIdx>> succ(step_count);
+    for (const auto& [a, b] : links)
+    {
+        succ[a].push_back(b);
+    }
+    std::vector<std::vector<bool>> reach(step_count, std::vector<bool>(step_count, false));
+    for (StepIdx s = 0; s < step_count; ++s)
+    {
+        std::vector<StepIdx> stack{s};
+        while (!stack.empty())
+        {
+            StepIdx u = stack.back();
+            stack.pop_back();
+            for (StepIdx v : succ[u])
+            {
+                if (!reach[s][v])
+                {
+                    reach[s][v] = true;
+                    stack.push_back(v);
+                }
+            }
+        }
+    }
+    return reach;
+}
+
+/// Random DAG: links only go from lower to higher index.
+std::vector<StepLinkPair> random_dag(size_t step_count, size_t link_count, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<size_t> dist(0, step_count - 1);
+    std::vector<StepLinkPair> links;
+    while (links.size() < link_count)
+    {
+        size_t a = dist(rng);
+        size_t b = dist(rng);
+        if (a != b)
+        {
+            links.emplace_back(std::min(a, b), std::max(a, b));
+        }
+    }
+    return links;
+}
+
+} // namespace
+
+// ============================================================================
+// Topological Sort Tests
+// ============================================================================
+
+TEST(StepGraphAlgorithmsTests, TopologicalSort_RespectsLinks)
+{
+    std::vector<StepLinkPair> links{{3, 1}, {1, 0}, {3, 2}, {2, 0}};
+    std::vector<StepIdx> order;
+    ASSERT_TRUE(topological_sort(4, links, order));
+    ASSERT_EQ(order.size(), 4u);
+    std::vector<size_t> pos(4);
+    for (size_t p = 0; p < order.size(); ++p)
+    {
+        pos[order[p]] = p;
+    }
+    for (const auto& [a, b] : links)
+    {
+        EXPECT_LT(pos[a], pos[b]);
+    }
+}
+
+TEST(StepGraphAlgorithmsTests, TopologicalSort_UnlinkedStepsInIndexOrder)
+{
+    std::vector<StepIdx> order;
+    ASSERT_TRUE(topological_sort(3, {}, order));
+    EXPECT_EQ(order, (std::vector<StepIdx>{0, 1, 2}));
+}
+
+TEST(StepGraphAlgorithmsTests, TopologicalSort_CycleReturnsFalse)
+{
+    std::vector<StepIdx> order;
+    EXPECT_FALSE(topological_sort(3, {{0, 1}, {1, 2}, {2, 1}}, order));
+    EXPECT_EQ(order, (std::vector<StepIdx>{0}));
+}
+
+TEST(StepGraphAlgorithmsTests, TopologicalSort_OutOfRangeThrows)
+{
+    std::vector<StepIdx> order;
+    EXPECT_THROW(topological_sort(2, {{0, 2}}, order), std::out_of_range);
+}
+
+// ============================================================================
+// Transitive Reduction Tests
+// ============================================================================
+// Level Tests
+// ============================================================================
+
+TEST(StepGraphAlgorithmsTests, Levels_LongestPathFromSource)
+{
+    // 0 -> 1 -> 3, 0 -> 3, 2 unlinked
+    std::vector<StepLinkPair> links{{0, 1}, {1, 3}, {0, 3}};
+    std::vector<StepIdx> order;
+    ASSERT_TRUE(topological_sort(4, links, order));
+    std::vector<size_t> levels;
+    compute_step_levels(4, links, order, levels);
+    EXPECT_EQ(levels, (std::vector<size_t>{0, 1, 0, 2}));
+
+    std::vector<size_t> offsets;
+    std::vector<StepIdx> steps;
+    group_steps_by_level(levels, offsets, steps);
+    EXPECT_EQ(offsets, (std::vector<size_t>{0, 2, 3, 4}));
+    EXPECT_EQ(steps, (std::vector<StepIdx>{0, 2, 1, 3}));
+}
+
+TEST(StepGraphAlgorithmsTests, Levels_OrderNotPermutationThrows)
+{
+    std::vector<size_t> levels;
+    EXPECT_THROW(compute_step_levels(3, {}, {0, 1}, levels), std::invalid_argument);
+    EXPECT_THROW(compute_step_levels(3, {}, {0, 1, 1}, levels), std::invalid_argument);
+}
+
+TEST(StepGraphAlgorithmsTests, Levels_GroupSkipsExcludedSteps)
+{
+    std::vector<size_t> offsets;
+    std::vector<StepIdx> steps;
+    group_steps_by_level({1, excluded_step_level, 0}, offsets, steps);
+    EXPECT_EQ(offsets, (std::vector<size_t>{0, 1, 2}));
+    EXPECT_EQ(steps, (std::vector<StepIdx>{2, 0}));
+}
+
+// ============================================================================
+
+TEST(StepGraphAlgorithmsTests, Reduce_RemovesDuplicates)
+{
+    std::vector<StepLinkPair> links{{0, 1}, {0, 1}, {0, 1}};
+    EXPECT_EQ(reduce_step_links(2, links), 2u);
+    EXPECT_EQ(links, (std::vector<StepLinkPair>{{0, 1}}));
+}
+
+TEST(StepGraphAlgorithmsTests, Reduce_RemovesImpliedLink)
+{
+    std::vector<StepLinkPair> links{{0, 2}, {0, 1}, {1, 2}};
+    EXPECT_EQ(reduce_step_links(3, links), 1u);
+    EXPECT_EQ(links, (std::vector<StepLinkPair>{{0, 1}, {1, 2}}));
+}
+
+TEST(StepGraphAlgorithmsTests, Reduce_DiamondIsKept)
+{
+    std::vector<StepLinkPair> links{{0, 1}, {0, 2}, {1, 3}, {2, 3}};
+    EXPECT_EQ(reduce_step_links(4, links), 0u);
+    EXPECT_EQ(links.size(), 4u);
+}
+
+TEST(StepGraphAlgorithmsTests, Reduce_CycleThrows)
+{
+    std::vector<StepLinkPair> links{{0, 1}, {1, 0}};
+    EXPECT_THROW(reduce_step_links(2, links), std::invalid_argument);
+}
+
+TEST(StepGraphAlgorithmsTests, Reduce_RandomDagMatchesBruteForce)
+{
+    for (uint32_t seed = 1; seed <= 5; ++seed)
+    {
+        const size_t n = 60;
+        std::vector<StepLinkPair> links = random_dag(n, 400, seed);
+        auto reach_before = brute_force_reachability(n, links);
+
+        std::vector<StepLinkPair> reduced = links;
+        size_t eliminated = reduce_step_links(n, reduced, 3);
+        EXPECT_EQ(eliminated + reduced.size(), links.size());
+        EXPECT_EQ(brute_force_reachability(n, reduced), reach_before);
+
+        // Minimality: no remaining link is implied by the others
+        for (size_t i = 0; i < reduced.size(); ++i)
+        {
+            std::vector<StepLinkPair> without = reduced;
+            without.erase(without.begin() + i);
+            auto reach = brute_force_reachability(n, without);
+            EXPECT_FALSE(reach[reduced[i].first][reduced[i].second]);
+        }
+    }
+}
+
+TEST(StepGraphAlgorithmsTests, Reduce_LargeChainWithShortcuts_MultipleBlocks)
+{
+    // Large enough that the reachability bitsets are split into column blocks
+    const size_t n = 20000;
+    std::vector<StepLinkPair> links;
+    for (size_t i = 0; i + 1 < n; ++i)
+    {
+        links.emplace_back(i, i + 1);
+        if (i + 2 < n)
+        {
+            links.emplace_back(i, i + 2);
+        }
+    }
+    EXPECT_EQ(reduce_step_links(n, links, 4), n - 2);
+    ASSERT_EQ(links.size(), n - 1);
+    for (size_t i = 0; i < links.size(); ++i)
+    {
+        EXPECT_EQ(links[i], StepLinkPair(i, i + 1));
+    }
+}